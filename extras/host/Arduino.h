@@ -0,0 +1,119 @@
+#ifndef TRF_HOST_ARDUINO_H
+#define TRF_HOST_ARDUINO_H
+
+/**
+ * Stand-in for the Arduino core so TinyRF can be compiled and run on a PC
+ * The transmitter and the receiver run in the same program: digitalWrite() on the TX pin changes
+ * the simulated line and calls the receiver's interrupt routine, and delayMicroseconds() moves
+ * the simulated clock that micros() returns. Everything is in one translation unit so the
+ * simulation state is defined here.
+**/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define CHANGE 1
+#define FALLING 2
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define F(x) x
+
+#define digitalPinToInterrupt(p) (p)
+#define digitalPinToPort(p) 0
+#define digitalPinToBitMask(p) 1
+#define portInputRegister(port) ((volatile uint8_t*)&sim_level)
+
+//the interrupt routine only runs from digitalWrite() so there is nothing to disable
+#define noInterrupts()
+#define interrupts()
+#define IRAM_ATTR
+
+
+/**
+ * Simulated link
+ * sim_skew scales every delay of the transmitter, e.g. 1.05 is a transmitter clock that is 5% slow
+ * sim_jitter adds a random -sim_jitter..+sim_jitter microseconds to every delay
+ * sim_ber is the chance that a delay of sim_a microseconds becomes sim_b or the other way around,
+ * set them to the LOW part of the ZERO and ONE pulses to swap bits
+**/
+unsigned long sim_now = 1000000;
+double sim_skew = 1.0;
+int sim_jitter = 0;
+double sim_ber = 0;
+unsigned sim_a = 0, sim_b = 0;
+
+//level of the line and the receiver's interrupt routine
+int sim_level = LOW;
+void (*sim_isr)() = NULL;
+int sim_mode = FALLING;
+
+inline unsigned long micros(){
+	return sim_now;
+}
+
+inline void delayMicroseconds(unsigned int us){
+	if(sim_ber > 0 && (us == sim_a || us == sim_b) && rand() < sim_ber * RAND_MAX){
+		us = (us == sim_a) ? sim_b : sim_a;
+	}
+	long jitter = sim_jitter ? (rand() % (2*sim_jitter + 1)) - sim_jitter : 0;
+	sim_now += (unsigned long)(us * sim_skew + 0.5 + jitter);
+}
+
+inline void pinMode(uint8_t, uint8_t){}
+
+inline int digitalRead(uint8_t){
+	return sim_level;
+}
+
+inline void digitalWrite(uint8_t, uint8_t level){
+	int old = sim_level;
+	sim_level = level;
+	if(sim_isr && old != level && (sim_mode == CHANGE || old == HIGH)){
+		sim_isr();
+	}
+}
+
+inline void attachInterrupt(uint8_t, void (*isr)(), int mode){
+	sim_isr = isr;
+	sim_mode = mode;
+}
+
+//Serial output is thrown away unless sim_serial is set, then it goes to stdout
+bool sim_serial = false;
+
+struct HostSerial{
+	void begin(long){}
+	void print(const char* s){
+		if(sim_serial) fputs(s, stdout);
+	}
+	void print(char c){
+		if(sim_serial) putchar(c);
+	}
+	template<class T> void print(T n){
+		if(sim_serial) printf("%ld", (long)n);
+	}
+	template<class T> void print(T n, int base){
+		if(sim_serial) printf(base == 16 ? "%lX" : "%ld", (long)n);
+	}
+	template<class T> void println(T x){
+		print(x);
+		println();
+	}
+	void println(){
+		if(sim_serial) putchar('\n');
+	}
+};
+HostSerial Serial;
+
+#endif	/* TRF_HOST_ARDUINO_H */
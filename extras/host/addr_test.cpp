@@ -0,0 +1,93 @@
+/**
+ * 12 transmitters, each with its own address and sequence numbers, send messages with
+ * sendMulti(..., 3) in random order, and some of their messages are dropped before they are sent
+ * Checks that every message is received once with the right sender address, and that the lost
+ * message count is right for every message except each sender's first, which has nothing to be
+ * compared with
+ * Exits with 1 if any check fails
+ * Build it with TRF_SENDER_ADDRESSING, see README.md
+**/
+
+#include <stdint.h>
+
+#define NUM_SENDERS 12
+#ifndef TRF_RX_MAX_SENDERS
+	#define TRF_RX_MAX_SENDERS NUM_SENDERS
+#endif
+
+//every message gets the address of the sender that is picked for it
+uint8_t txAddr = 0;
+#define TRF_TX_ADDRESS txAddr
+
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+#if !defined(TRF_SENDER_ADDRESSING) || defined(TRF_SEQ_DISABLED)
+	#error "Build it with TRF_SENDER_ADDRESSING and sequence numbering."
+#endif
+
+const int NUM_MESSAGES = 400;
+const uint8_t FIRST_ADDR = 10;
+
+int main(){
+	setupReceiver(2);
+	setupTransmitter();
+	srand(1);
+
+	//each sender's sequence number, and how many of its messages were dropped since the last one
+	uint8_t seqs[NUM_SENDERS];
+	uint8_t numDropped[NUM_SENDERS] = {0};
+	bool heardFrom[NUM_SENDERS] = {false};
+	for(uint8_t s=0; s<NUM_SENDERS; s++){
+		seqs[s] = rand();
+	}
+
+	int numSent = 0;
+	int ok = 0;
+	int errors = 0;
+	int duplicates = 0;
+	int wrongLost = 0;
+	for(int m=0; m<NUM_MESSAGES; m++){
+		uint8_t s = rand() % NUM_SENDERS;
+		char msg[12];
+		snprintf(msg, sizeof(msg), "m%d-%d", s, m);
+		if(rand() % 7 == 0){
+			seqs[s]++;
+			numDropped[s]++;
+			continue;
+		}
+		txAddr = FIRST_ADDR + s;
+		seq = seqs[s];
+		sendMulti((byte*)msg, strlen(msg), 3);
+		seqs[s] = seq;
+		sim_now += TX_DELAY_MICROS;
+		numSent++;
+
+		int numReceived = 0;
+		byte buf[40];
+		uint8_t numRcvdBytes;
+		uint8_t numLost;
+		uint8_t senderAddr;
+		uint8_t err;
+		while((err = getReceivedData(buf, sizeof(buf), numRcvdBytes, numLost, senderAddr)) != TRF_ERR_NO_DATA){
+			if(err != TRF_ERR_SUCCESS || numRcvdBytes != strlen(msg) || memcmp(buf, msg, numRcvdBytes)
+				|| senderAddr != FIRST_ADDR + s){
+				errors++;
+				continue;
+			}
+			numReceived++;
+			if(heardFrom[s] && numLost != numDropped[s]){
+				wrongLost++;
+			}
+			heardFrom[s] = true;
+			numDropped[s] = 0;
+		}
+		ok += numReceived > 0;
+		duplicates += numReceived > 1;
+	}
+
+	printf("%d/%d received with the right sender, %d errors, %d duplicates, %d wrong lost counts\n",
+		ok, numSent, errors, duplicates, wrongLost);
+	return (ok == numSent && !errors && !duplicates && !wrongLost) ? 0 : 1;
+}
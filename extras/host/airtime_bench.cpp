@@ -0,0 +1,57 @@
+/**
+ * Measures how long transmitByte() takes on the simulated clock, averaged over all 256 byte values
+ * Then sends 20 byte messages with send() and checks that none takes longer than airtimeMicros(20),
+ * with manchester code they have to take exactly that long, exits with 1 if not
+ * See README.md for how to build it
+**/
+
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+const uint8_t MSG_LEN = 20;
+
+int main(){
+#if defined(TRF_SYMBOLS_4LEVEL)
+	const char* lineCode = "4-level symbols";
+#elif defined(TRF_LINE_CODE_MANCHESTER)
+	const char* lineCode = "Manchester";
+#else
+	const char* lineCode = "pulse period";
+#endif
+
+	setupTransmitter();
+	unsigned long start = sim_now;
+	for(int b=0; b<256; b++){
+		transmitByte(b);
+	}
+	printf("%-16s %4lu us per byte on average\n", lineCode, (sim_now - start + 128) / 256);
+
+	//all 0s, all 1s and random data, the CRC and seq bytes differ each time too
+	unsigned long longest = 0;
+	bool ok = true;
+	srand(1);
+	for(int i=0; i<12; i++){
+		byte msg[MSG_LEN];
+		for(uint8_t j=0; j<MSG_LEN; j++){
+			msg[j] = (i % 3 == 0) ? 0x00 : ((i % 3 == 1) ? 0xFF : rand());
+		}
+		start = sim_now;
+		send(msg, MSG_LEN);
+		unsigned long took = sim_now - start;
+		if(took > longest){
+			longest = took;
+		}
+#ifdef TRF_LINE_CODE_MANCHESTER
+		if(took != airtimeMicros(MSG_LEN)){
+			ok = false;
+		}
+#endif
+	}
+	if(longest > airtimeMicros(MSG_LEN)){
+		ok = false;
+	}
+	printf("%-16s send(%d) took at most %lu us, airtimeMicros(%d) is %lu us%s\n", lineCode, MSG_LEN,
+		longest, MSG_LEN, (unsigned long)airtimeMicros(MSG_LEN), ok ? "" : " WRONG");
+	return ok ? 0 : 1;
+}
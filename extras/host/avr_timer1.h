@@ -0,0 +1,87 @@
+#ifndef TRF_HOST_AVR_TIMER1_H
+#define TRF_HOST_AVR_TIMER1_H
+
+/**
+ * Makes the host build look like an ATmega328 so the Timer1 code (TRF_TX_ASYNC and
+ * TRF_TX_OUTPUT_COMPARE) can be compiled, include it after Arduino.h and before TinyRF
+ * The registers are plain variables and nothing runs on its own, run_timer1() plays the
+ * transmitter's compare interrupts. Writes to the port registers go to the simulated line
+**/
+
+#include "Arduino.h"
+
+#define __AVR_ATmega328P__
+#define F_CPU 16000000L
+
+#define ISR(vector) void vector()
+#define cli()
+#define sei()
+
+volatile uint8_t TCCR1A, TCCR1B, TIFR1, TIMSK1;
+volatile uint16_t TCNT1, OCR1A, OCR1B, ICR1;
+
+//TCCR1A
+#define COM1A1 7
+#define COM1A0 6
+#define WGM11 1
+#define WGM10 0
+//TCCR1B
+#define ICNC1 7
+#define ICES1 6
+#define WGM13 4
+#define WGM12 3
+#define CS12 2
+#define CS11 1
+#define CS10 0
+//TIFR1 and TIMSK1
+#define ICF1 5
+#define ICIE1 5
+#define OCF1B 2
+#define OCIE1B 2
+#define OCF1A 1
+#define OCIE1A 1
+#define TOV1 0
+#define TOIE1 0
+
+//the transmitter is the only one writing to a port, so |= sets the line HIGH and &= sets it LOW
+struct HostPort{
+	uint8_t value;
+	HostPort& operator|=(uint8_t mask){
+		value |= mask;
+		digitalWrite(0, HIGH);
+		return *this;
+	}
+	HostPort& operator&=(uint8_t mask){
+		value &= mask;
+		digitalWrite(0, LOW);
+		return *this;
+	}
+};
+HostPort PORTB, PORTC, PORTD;
+
+//defined by the transmitter with TRF_TX_ASYNC
+void TIMER1_COMPA_vect();
+
+/**
+ * Runs Timer1 until the transmitter turns off its interrupt, at 16MHz with prescaler 8 there are
+ * two ticks per us. The interrupt runs a random 0..maxLatency us after its compare match, like
+ * another interrupt or a long cli() section would make it. With TRF_TX_OUTPUT_COMPARE the compare
+ * unit sets OC1A to the level the last interrupt asked for right on the match
+**/
+inline void run_timer1(int maxLatency){
+	unsigned long start = sim_now;
+	unsigned long long ticks = 0;
+	while(TIMSK1 & (1 << OCIE1A)){
+		ticks += (uint16_t)(OCR1A - TCNT1);
+		TCNT1 = OCR1A;
+		sim_now = start + ticks/2;
+		if(TCCR1A & (1 << COM1A1)){
+			digitalWrite(0, (TCCR1A >> COM1A0) & 1);
+		}
+		sim_now = start + ticks/2 + (maxLatency ? rand() % (maxLatency + 1) : 0);
+		TIMER1_COMPA_vect();
+	}
+	sim_now = start + ticks/2;
+}
+
+#endif	/* TRF_HOST_AVR_TIMER1_H */
@@ -0,0 +1,86 @@
+/**
+ * Checks crc8() against the bit by bit Dallas/Maxim loop and measures how fast it is
+ * Build it with TRF_CRC8_NIBBLE_TABLE, TRF_CRC8_BYTE_TABLE or neither to compare the variants
+ * On x86 the speed is in TSC cycles per byte, elsewhere in nanoseconds per byte. It's only useful
+ * for comparing the variants with each other, on AVR all of them are a lot slower
+ * See README.md for how to build it
+**/
+
+#include "TinyRF_RX.h"
+#include "tiny/TinyRF.cpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h>
+	#define BENCH_CLOCK() __rdtsc()
+	#define BENCH_UNIT "cycles"
+#else
+	#include <chrono>
+	#define BENCH_CLOCK() (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>( \
+		std::chrono::steady_clock::now().time_since_epoch()).count()
+	#define BENCH_UNIT "ns"
+#endif
+
+const uint8_t FRAME_LEN = 32;
+const int NUM_CHECKS = 100000;
+const int NUM_RUNS = 50;
+
+byte reference_crc8(const byte data[], uint8_t len, uint8_t seq){
+	byte crc = seq;
+	while(len--){
+		byte extract = *data++;
+		for(byte i=0; i<8; i++){
+			byte sum = (crc ^ extract) & 0x01;
+			crc >>= 1;
+			if(sum){
+				crc ^= 0x8C;
+			}
+			extract >>= 1;
+		}
+	}
+	return crc;
+}
+
+static byte data[1 << 16];
+
+int main(){
+#if defined(TRF_CRC8_BYTE_TABLE)
+	const char* variant = "byte table";
+#elif defined(TRF_CRC8_NIBBLE_TABLE)
+	const char* variant = "nibble table";
+#else
+	const char* variant = "bitwise";
+#endif
+
+	srand(1);
+	for(unsigned i=0; i<sizeof(data); i++){
+		data[i] = rand();
+	}
+
+	//random lengths, offsets and seeds
+	for(int i=0; i<NUM_CHECKS; i++){
+		unsigned offset = rand() % (sizeof(data) - 256);
+		uint8_t len = rand();
+		uint8_t seq = rand();
+		if(crc8(&data[offset], len, seq) != reference_crc8(&data[offset], len, seq)){
+			printf("%s: crc8() doesn't match the reference at offset %u, len %d\n", variant, offset, len);
+			return 1;
+		}
+	}
+
+	//the whole buffer in FRAME_LEN byte frames, the best run is reported
+	volatile byte sink = 0;
+	unsigned long long best = ~0ULL;
+	for(int r=0; r<NUM_RUNS; r++){
+		unsigned long long start = BENCH_CLOCK();
+		for(unsigned offset=0; offset + FRAME_LEN <= sizeof(data); offset += FRAME_LEN){
+			sink ^= crc8(&data[offset], FRAME_LEN, offset);
+		}
+		unsigned long long elapsed = BENCH_CLOCK() - start;
+		if(elapsed < best){
+			best = elapsed;
+		}
+	}
+
+	printf("%-12s matches the reference, %5.1f %s/byte\n", variant, (double)best / sizeof(data), BENCH_UNIT);
+	return 0;
+}
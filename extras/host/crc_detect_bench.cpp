@@ -0,0 +1,45 @@
+/**
+ * Counts how many corrupted frames checksum8(), crc8() and crc16() fail to detect
+ * Each of the 2000000 random 50 byte frames gets 2 to 6 random bits flipped, the frames where the
+ * flips cancel out are skipped. This is a benchmark, it doesn't fail
+ * See README.md for how to build it
+**/
+
+#include "TinyRF_RX.h"
+#include "tiny/TinyRF.cpp"
+
+const uint8_t FRAME_LEN = 50;
+const long NUM_FRAMES = 2000000;
+const uint8_t SEQ = 7;
+
+int main(){
+	srand(3);
+	long corrupted = 0;
+	long undetectedChecksum = 0;
+	long undetectedCrc8 = 0;
+	long undetectedCrc16 = 0;
+	for(long n=0; n<NUM_FRAMES; n++){
+		byte sent[FRAME_LEN];
+		byte rcvd[FRAME_LEN];
+		for(uint8_t i=0; i<FRAME_LEN; i++){
+			sent[i] = rcvd[i] = rand();
+		}
+		int numFlips = 2 + rand() % 5;
+		for(int f=0; f<numFlips; f++){
+			int bit = rand() % (FRAME_LEN * 8);
+			rcvd[bit / 8] ^= 1 << (bit % 8);
+		}
+		if(!memcmp(sent, rcvd, FRAME_LEN)){
+			continue;
+		}
+		corrupted++;
+		undetectedChecksum += checksum8(sent, FRAME_LEN, SEQ) == checksum8(rcvd, FRAME_LEN, SEQ);
+		undetectedCrc8 += crc8(sent, FRAME_LEN, SEQ) == crc8(rcvd, FRAME_LEN, SEQ);
+		undetectedCrc16 += crc16(sent, FRAME_LEN, SEQ) == crc16(rcvd, FRAME_LEN, SEQ);
+	}
+
+	printf("crc16(\"123456789\") = %04X (CRC-16/ARC check value is BB3D)\n", crc16((byte*)"123456789", 9));
+	printf("undetected of %ld corrupted %d byte frames:\n", corrupted, FRAME_LEN);
+	printf("  checksum8 %ld\n  crc8      %ld\n  crc16     %ld\n", undetectedChecksum, undetectedCrc8, undetectedCrc16);
+	return 0;
+}
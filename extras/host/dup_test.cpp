@@ -0,0 +1,82 @@
+/**
+ * Checks that the repetitions sent by sendMulti() don't take up buffer space or push other
+ * messages out of it, and that every message gets through exactly once
+ * Exits with 1 if any case fails
+ * Repetitions are recognized by their sequence number, so this doesn't work with TRF_SEQ_DISABLED
+ * See README.md for how to build it
+**/
+
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+#ifdef TRF_SEQ_DISABLED
+	#error "Repetitions can't be told apart from new messages with TRF_SEQ_DISABLED."
+#endif
+
+const uint8_t MAX_MSGS = 16;
+
+/**
+ * Sends 'numMsgs' different messages of 'len' bytes 'times' times each, then reads the buffer
+ * Repeats that 'numRounds' times and returns the number of messages that were received intact,
+ * 'numReads' is the number of messages getReceivedData() returned in total
+**/
+int send_and_read(uint8_t numMsgs, uint8_t len, uint8_t times, int numRounds, int &numReads){
+	int good = 0;
+	numReads = 0;
+	for(int round=0; round<numRounds; round++){
+		byte msgs[MAX_MSGS][TRF_MAX_MSG_LEN];
+		for(uint8_t i=0; i<numMsgs; i++){
+			for(uint8_t k=0; k<len; k++){
+				msgs[i][k] = rand();
+			}
+			//the first byte tells the messages apart
+			msgs[i][0] = i;
+			sendMulti(msgs[i], len, times);
+			sim_now += TX_DELAY_MICROS;
+		}
+		bool received[MAX_MSGS] = {false};
+		byte buf[TRF_MAX_MSG_LEN];
+		uint8_t numRcvdBytes;
+		uint8_t err;
+		while((err = getReceivedData(buf, sizeof(buf), numRcvdBytes)) != TRF_ERR_NO_DATA){
+			numReads++;
+			if(err == TRF_ERR_SUCCESS && numRcvdBytes == len && buf[0] < numMsgs
+				&& !memcmp(buf, msgs[buf[0]], len)){
+				received[buf[0]] = true;
+			}
+		}
+		for(uint8_t i=0; i<numMsgs; i++){
+			good += received[i];
+		}
+	}
+	return good;
+}
+
+bool check(const char* name, uint8_t numMsgs, uint8_t len, uint8_t times, int numRounds){
+	int numReads;
+	int good = send_and_read(numMsgs, len, times, numRounds, numReads);
+	int total = numMsgs * numRounds;
+	bool passed = (good == total && numReads == total);
+	printf("%-44s %d/%d received, %d reads %s\n", name, good, total, numReads, passed ? "" : "FAILED");
+	return passed;
+}
+
+int main(){
+	setupReceiver(2);
+	setupTransmitter();
+	srand(3);
+
+	bool passed = true;
+	//lots of short messages, only the first copy of each should be stored
+	passed &= check("8 x 10 bytes, sendMulti(.., 2)", 8, 10, 2, 100);
+	passed &= check("8 x 10 bytes, sendMulti(.., 3)", 8, 10, 3, 100);
+	//together the three messages almost fill the buffer, a stored repeat would push one out
+	passed &= check("3 x 30 bytes, send()", 3, 30, 1, 50);
+	passed &= check("3 x 30 bytes, sendMulti(.., 2)", 3, 30, 2, 50);
+	passed &= check("3 x 30 bytes, sendMulti(.., 3)", 3, 30, 3, 50);
+	//the repeat of a message that is more than half the buffer
+	passed &= check("1 x 70 bytes, sendMulti(.., 2)", 1, 70, 2, 20);
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+/**
+ * Sends messages at skews from 0.90 to 1.10 with +/-15us of jitter, which corrupts some of them,
+ * and prints the number of messages received intact, a hash of them (length, lost count and data)
+ * and the number of frames that failed error checking
+ * With TRF_RX_ISR_ERR_CHK the corrupted frames are thrown away in the interrupt instead of being
+ * returned by getReceivedData(), both are counted by TRF_RX_STATS
+ * `run.sh` builds it with and without TRF_RX_ISR_ERR_CHK and fails if the output differs
+ * See README.md for how to build it
+**/
+
+#define TRF_RX_STATS
+
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+const double skews[] = {0.90, 1.00, 1.07, 1.10};
+const char* msgs[] = {"Hello from far away!", "x", "abcdefghijklmnopqrstuvwxyz0123"};
+const int NUM_ROUNDS = 20;
+
+//FNV-1a
+uint32_t hash_bytes(uint32_t hash, const byte data[], uint8_t len){
+	for(uint8_t i=0; i<len; i++){
+		hash = (hash ^ data[i]) * 16777619UL;
+	}
+	return hash;
+}
+
+int main(){
+	setupReceiver(2);
+	setupTransmitter();
+	sim_jitter = 15;
+	srand(1);
+
+	for(double skew : skews){
+		sim_skew = skew;
+		resetRxStats();
+		int ok = 0;
+		uint32_t hash = 2166136261UL;
+		for(int r=0; r<NUM_ROUNDS; r++){
+			for(const char* msg : msgs){
+				sendMulti((byte*)msg, strlen(msg), 2);
+				sim_now += TX_DELAY_MICROS;
+				byte buf[40];
+				uint8_t numRcvdBytes = 0;
+				uint8_t numLost = 0;
+				uint8_t err;
+				while((err = getReceivedData(buf, sizeof(buf), numRcvdBytes, numLost)) != TRF_ERR_NO_DATA){
+					if(err == TRF_ERR_SUCCESS){
+						byte result[2] = {numRcvdBytes, numLost};
+						hash = hash_bytes(hash, result, sizeof(result));
+						hash = hash_bytes(hash, buf, numRcvdBytes);
+						ok++;
+					}
+				}
+			}
+		}
+		TRFRxStats stats;
+		getRxStats(stats);
+		printf("skew %.2f: %d intact, hash %08lx, %u corrupted\n", skew, ok, (unsigned long)hash, stats.corrupted);
+	}
+	return 0;
+}
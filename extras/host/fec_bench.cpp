@@ -0,0 +1,76 @@
+/**
+ * Goodput of send() and sendMulti() at different bit error rates
+ * Bit errors are made by swapping the LOW part of ZERO and ONE pulses, which is the kind of error
+ * TRF_FEC_HAMMING corrects. Build it with and without TRF_FEC_HAMMING to compare them
+ * See README.md for how to build it
+**/
+
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+const double bitErrorRates[] = {0, 0.001, 0.005, 0.01, 0.02};
+const int NUM_FRAMES = 2000;
+const uint8_t MSG_LEN = 20;
+
+//sends NUM_FRAMES messages 'times' times each and prints how many got through
+void run(double ber, uint8_t times){
+	sim_ber = ber;
+	srand(1);
+	int good = 0;
+	unsigned long start = sim_now;
+
+	for(int i=0; i<NUM_FRAMES; i++){
+		byte msg[MSG_LEN];
+		for(uint8_t k=0; k<MSG_LEN; k++){
+			msg[k] = rand();
+		}
+		//so that consecutive messages are never the same
+		msg[0] = i;
+		msg[1] = i >> 8;
+
+		if(times > 1){
+			sendMulti(msg, MSG_LEN, times);
+		}
+		else{
+			send(msg, MSG_LEN);
+		}
+		sim_now += TX_DELAY_MICROS;
+
+		byte buf[40];
+		uint8_t numRcvdBytes;
+		uint8_t err;
+		bool received = false;
+		while((err = getReceivedData(buf, sizeof(buf), numRcvdBytes)) != TRF_ERR_NO_DATA){
+			if(err == TRF_ERR_SUCCESS && numRcvdBytes == MSG_LEN && !memcmp(buf, msg, MSG_LEN)){
+				received = true;
+			}
+		}
+		good += received;
+	}
+
+	double secs = (sim_now - start) / 1e6;
+	printf("  %6.1f%% %6.1f B/s", 100.0 * good / NUM_FRAMES, good * MSG_LEN / secs);
+}
+
+int main(){
+	setupReceiver(2);
+	setupTransmitter();
+	sim_a = ZERO_PULSE_PERIOD - PERIOD_HIGH_DURATION;
+	sim_b = ONE_PULSE_PERIOD - PERIOD_HIGH_DURATION;
+
+#ifdef TRF_FEC_HAMMING
+	printf("TRF_FEC_HAMMING, %d frames of %d bytes\n", NUM_FRAMES, MSG_LEN);
+#else
+	printf("no FEC, %d frames of %d bytes\n", NUM_FRAMES, MSG_LEN);
+#endif
+	printf("    BER        send()              sendMulti(.., 3)\n");
+	for(double ber : bitErrorRates){
+		printf("  %4.1f%%", ber * 100);
+		run(ber, 1);
+		run(ber, 3);
+		printf("\n");
+	}
+
+	return 0;
+}
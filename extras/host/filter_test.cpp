@@ -0,0 +1,90 @@
+/**
+ * Sends batches of 6 messages from 6 senders into a 64 byte receive buffer and reads it after
+ * each batch. The messages from odd senders are unwanted, and they start and end with an 'X' so
+ * they can be told apart by content in either data order.
+ * With TRF_RX_FILTER they are dropped by the receive filter, by sender address with
+ * TRF_SENDER_ADDRESSING and by the first byte on the air without it. Prints how many of the wanted
+ * messages were read and how many unwanted ones got into the buffer
+ * Exits with 1 if an unwanted message got into the buffer with TRF_RX_FILTER
+ * See README.md for how to build it
+**/
+
+#include <stdint.h>
+
+#ifndef TRF_RX_BUFFER_SIZE
+	#define TRF_RX_BUFFER_SIZE 64
+#endif
+
+//every message gets the address of the sender that is picked for it
+uint8_t txAddr = 0;
+#define TRF_TX_ADDRESS txAddr
+
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+const int NUM_BATCHES = 50;
+const int BATCH_SIZE = 6;
+
+#ifdef TRF_RX_FILTER
+bool wanted(uint8_t, uint8_t senderAddr, byte firstByte){
+	#ifdef TRF_SENDER_ADDRESSING
+	(void)firstByte;
+	return (senderAddr & 1) == 0;
+	#else
+	(void)senderAddr;
+	return firstByte != 'X';
+	#endif
+}
+#endif
+
+int main(){
+	setupReceiver(2);
+	setupTransmitter();
+#ifdef TRF_RX_FILTER
+	setReceiveFilter(wanted);
+#endif
+	srand(3);
+
+	int numWanted = 0;
+	int wantedRead = 0;
+	int unwantedRead = 0;
+	int errors = 0;
+	for(int b=0; b<NUM_BATCHES; b++){
+		for(int k=0; k<BATCH_SIZE; k++){
+			uint8_t sender = rand() % 6;
+			txAddr = sender;
+			char marker = (sender & 1) ? 'X' : 'm';
+			char msg[24];
+			snprintf(msg, sizeof(msg), "%cmessage-%02d-%02d-x%c", marker, b, k, marker);
+			send((byte*)msg, strlen(msg));
+			sim_now += TX_DELAY_MICROS;
+			if(!(sender & 1)){
+				numWanted++;
+			}
+		}
+
+		byte buf[40];
+		uint8_t numRcvdBytes;
+		uint8_t err;
+		while((err = getReceivedData(buf, sizeof(buf), numRcvdBytes)) != TRF_ERR_NO_DATA){
+			if(err != TRF_ERR_SUCCESS){
+				errors++;
+			}
+			else if(buf[0] == 'X'){
+				unwantedRead++;
+			}
+			else{
+				wantedRead++;
+			}
+		}
+	}
+
+	printf("%d/%d wanted messages read, %d unwanted ones got into the buffer, %d errors\n",
+		wantedRead, numWanted, unwantedRead, errors);
+#ifdef TRF_RX_FILTER
+	return unwantedRead == 0 ? 0 : 1;
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,69 @@
+/**
+ * Sends 20 messages with the transmitter's clock 5% slow and +/-20us of jitter and prints the
+ * TRF_RX_HISTOGRAM with printRxHistogram(), the ZERO, ONE and START pulses should form clusters
+ * Arguments set the skew and the jitter, e.g. 1.00 0 for a perfect transmitter
+ * Exits with 1 if a message was lost, if the bins don't add up to the number of interrupts counted by
+ * TRF_RX_STATS or if resetRxHistogram() doesn't clear them
+ * See README.md for how to build it
+**/
+
+#define TRF_RX_STATS
+
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+#ifndef TRF_RX_HISTOGRAM
+	#error "Build with -DTRF_RX_HISTOGRAM."
+#endif
+
+const uint8_t MSG_LEN = 20;
+const int NUM_MSGS = 20;
+
+unsigned long hist_total(){
+	unsigned long total = 0;
+	for(uint8_t i=0; i<TRF_RX_HIST_BINS; i++){
+		total += tinyrf::rxHistogram[i];
+	}
+	return total;
+}
+
+int main(int argc, char** argv){
+	sim_skew = (argc > 1) ? atof(argv[1]) : 1.05;
+	sim_jitter = (argc > 2) ? atoi(argv[2]) : 20;
+	setupReceiver(2);
+	setupTransmitter();
+	srand(2);
+
+	byte msg[MSG_LEN];
+	for(uint8_t i=0; i<MSG_LEN; i++){
+		msg[i] = rand();
+	}
+	int numReceived = 0;
+	for(int i=0; i<NUM_MSGS; i++){
+		send(msg, MSG_LEN);
+		sim_now += TX_DELAY_MICROS;
+		byte buf[30];
+		uint8_t numRcvdBytes;
+		while(getReceivedData(buf, sizeof(buf), numRcvdBytes) != TRF_ERR_NO_DATA){
+			if(numRcvdBytes == MSG_LEN && !memcmp(buf, msg, MSG_LEN)){
+				numReceived++;
+			}
+		}
+	}
+
+	sim_serial = true;
+	printf("skew %.2f, jitter %dus, %d/%d received\n", sim_skew, sim_jitter, numReceived, NUM_MSGS);
+	printRxHistogram();
+	sim_serial = false;
+
+	TRFRxStats stats;
+	getRxStats(stats);
+	bool ok = numReceived == NUM_MSGS && hist_total() == stats.edges;
+	resetRxHistogram();
+	if(hist_total() != 0){
+		printf("resetRxHistogram() didn't clear the bins\n");
+		ok = false;
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+/**
+ * Sends 4 good frames per round, each followed by 1 or 2 bursts of noise that look like a frame:
+ * a START pulse and 8-127 random ONE/ZERO pulses. The buffer is only read after the round, so
+ * noise that is stored pushes good frames out of it
+ * Prints how many good frames were read, exits with 1 if any were lost
+ * See README.md for how to build it
+**/
+
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+const int NUM_ROUNDS = 200;
+const uint8_t FRAMES_PER_ROUND = 4;
+const uint8_t FRAME_LEN = 10;
+
+void pulse(unsigned period){
+	digitalWrite(TRF_TX_PIN, HIGH);
+	delayMicroseconds(PERIOD_HIGH_DURATION);
+	digitalWrite(TRF_TX_PIN, LOW);
+	delayMicroseconds(period - PERIOD_HIGH_DURATION);
+}
+
+void send_noise(){
+	pulse(START_PULSE_PERIOD);
+	int numPulses = 8 + rand() % 120;
+	for(int p=0; p<numPulses; p++){
+		pulse((rand() & 1) ? ONE_PULSE_PERIOD : ZERO_PULSE_PERIOD);
+	}
+	sim_now += TX_DELAY_MICROS;
+}
+
+//returns the number of good frames that were read
+int run(int numBursts){
+	int good = 0;
+	for(int r=0; r<NUM_ROUNDS; r++){
+		byte frames[FRAMES_PER_ROUND][FRAME_LEN];
+		for(uint8_t i=0; i<FRAMES_PER_ROUND; i++){
+			for(uint8_t k=0; k<FRAME_LEN; k++){
+				frames[i][k] = rand();
+			}
+			//the first byte tells the frames apart
+			frames[i][0] = i;
+			send(frames[i], FRAME_LEN);
+			sim_now += TX_DELAY_MICROS;
+			for(int b=0; b<numBursts; b++){
+				send_noise();
+			}
+		}
+
+		bool received[FRAMES_PER_ROUND] = {false};
+		byte buf[40];
+		uint8_t numRcvdBytes;
+		uint8_t err;
+		while((err = getReceivedData(buf, sizeof(buf), numRcvdBytes)) != TRF_ERR_NO_DATA){
+			if(err == TRF_ERR_SUCCESS && numRcvdBytes == FRAME_LEN && buf[0] < FRAMES_PER_ROUND
+				&& !memcmp(buf, frames[buf[0]], FRAME_LEN)){
+				received[buf[0]] = true;
+			}
+		}
+		for(uint8_t i=0; i<FRAMES_PER_ROUND; i++){
+			good += received[i];
+		}
+	}
+	return good;
+}
+
+int main(){
+	setupReceiver(2);
+	setupTransmitter();
+	srand(7);
+
+	bool allReceived = true;
+	for(int numBursts=1; numBursts<=2; numBursts++){
+		int good = run(numBursts);
+		int total = NUM_ROUNDS * FRAMES_PER_ROUND;
+		printf("%d noise burst(s) after each frame: %d/%d good frames read\n", numBursts, good, total);
+		if(good != total){
+			allReceived = false;
+		}
+	}
+
+	return allReceived ? 0 : 1;
+}
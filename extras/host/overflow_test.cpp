@@ -0,0 +1,70 @@
+/**
+ * Sends 10 messages of 10 to 24 bytes without reading, which is more than the receive buffer
+ * holds, then reads all of them, 3 times over. The oldest messages are overwritten, so what is
+ * read has to be the newest messages in the order they were sent, intact, and the first of them
+ * has to report the overwritten ones as lost (except in the first round, where there is no
+ * earlier message to compare with)
+ * Exits with 1 if any check fails
+ * See README.md for how to build it
+**/
+
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+const int NUM_ROUNDS = 3;
+const uint8_t MSGS_PER_ROUND = 10;
+
+int main(){
+	setupReceiver(2);
+	setupTransmitter();
+
+	bool passed = true;
+	for(int r=0; r<NUM_ROUNDS; r++){
+		char msgs[MSGS_PER_ROUND][32];
+		uint8_t lens[MSGS_PER_ROUND];
+		for(uint8_t i=0; i<MSGS_PER_ROUND; i++){
+			lens[i] = 10 + (i*7 + r) % 15;
+			for(uint8_t k=0; k<lens[i]; k++){
+				msgs[i][k] = 'a' + (i + k) % 26;
+			}
+			send((byte*)msgs[i], lens[i]);
+			sim_now += TX_DELAY_MICROS;
+		}
+
+		//the messages that were read, by their index
+		int read[MSGS_PER_ROUND];
+		uint8_t firstLost = 0;
+		int numRead = 0;
+		bool intact = true;
+		byte buf[40];
+		uint8_t numRcvdBytes;
+		uint8_t numLost;
+		uint8_t err;
+		while((err = getReceivedData(buf, sizeof(buf), numRcvdBytes, numLost)) != TRF_ERR_NO_DATA){
+			int i = buf[0] - 'a';
+			if(err != TRF_ERR_SUCCESS || i < 0 || i >= MSGS_PER_ROUND || numRcvdBytes != lens[i]
+				|| memcmp(buf, msgs[i], numRcvdBytes) || numRead == MSGS_PER_ROUND
+				|| (numRead > 0 && numLost != 0)){
+				intact = false;
+				break;
+			}
+			if(numRead == 0){
+				firstLost = numLost;
+			}
+			read[numRead++] = i;
+		}
+
+		bool newest = numRead > 0;
+		for(int k=0; k<numRead; k++){
+			newest &= read[k] == MSGS_PER_ROUND - numRead + k;
+		}
+		uint8_t expectedLost = (r == 0) ? 0 : MSGS_PER_ROUND - numRead;
+		bool ok = intact && newest && firstLost == expectedLost;
+		printf("round %d: the newest %d of %d read, %d reported lost %s\n",
+			r, numRead, MSGS_PER_ROUND, firstLost, ok ? "" : "FAILED");
+		passed &= ok;
+	}
+
+	return passed ? 0 : 1;
+}
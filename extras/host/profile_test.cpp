@@ -0,0 +1,80 @@
+/**
+ * Checks what TRF_RX_PROFILE counts and how it averages
+ * The simulated clock doesn't move while the interrupt runs, so every measured duration is 0, instead
+ * this sends 50 messages and checks that each byte of them was counted once as an interrupt that 
+ * completed a byte, then feeds known durations to profile_add() and checks min/avg/max
+ * Prints the numbers, exits with 1 if one of them is wrong
+ * See README.md for how to build it
+**/
+
+//Timer1 is only simulated for the transmitter, these builds are compiled but not run
+#if defined(TRF_RX_INPUT_CAPTURE) || defined(TRF_EOT_TIMER)
+	#include "avr_timer1.h"
+#endif
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+#ifndef TRF_RX_PROFILE
+	#error "Build with -DTRF_RX_PROFILE."
+#endif
+
+const uint8_t MSG_LEN = 20;
+const int NUM_MSGS = 50;
+
+int main(){
+	using namespace tinyrf;
+	setupReceiver(2);
+	setupTransmitter();
+	bool ok = true;
+
+	//nothing measured yet
+	TRFRxProfile profile;
+	getRxProfile(profile);
+	if(profile.edge.max || profile.byteEdge.max || profile.read.max){
+		ok = false;
+	}
+
+	byte msg[MSG_LEN] = {1, 2, 3};
+	int numReads = 0;
+	for(int i=0; i<NUM_MSGS; i++){
+		send(msg, MSG_LEN);
+		sim_now += TX_DELAY_MICROS;
+		byte buf[30];
+		uint8_t numRcvdBytes;
+		numReads++;
+		while(getReceivedData(buf, sizeof(buf), numRcvdBytes) != TRF_ERR_NO_DATA){
+			numReads++;
+		}
+	}
+	//the len byte, the data and the frame overhead, with TRF_FEC_HAMMING each codeword counts
+	int numBytes = NUM_MSGS * (MSG_LEN + 1 + TRF_FRAME_OVERHEAD) * TRF_TX_BYTES_PER_BYTE;
+	printf("%d frames of %d bytes: %u byte-completing interrupts, %u other interrupts, %u reads\n",
+		NUM_MSGS, MSG_LEN + 1 + TRF_FRAME_OVERHEAD, byteEdgeProf.count, edgeProf.count, readProf.count);
+	if(byteEdgeProf.count != numBytes || readProf.count != numReads){
+		ok = false;
+	}
+
+	//half of the durations are 10 and half 30, then one short and one long one
+	//the sum and count are halved before they overflow, so the average is closer to the recent 30s
+	resetRxProfile();
+	for(long i=0; i<100000; i++){
+		profile_add(edgeProf, i < 50000 ? 10 : 30);
+	}
+	profile_add(edgeProf, 5);
+	profile_add(edgeProf, 900);
+	getRxProfile(profile);
+	printf("10 50000 times, 30 50000 times, 5 and 900: min %u avg %u max %u\n", profile.edge.min,
+		profile.edge.avg, profile.edge.max);
+	if(profile.edge.min != 5 || profile.edge.max != 900 || profile.edge.avg <= 20 || profile.edge.avg > 30){
+		ok = false;
+	}
+
+	resetRxProfile();
+	getRxProfile(profile);
+	if(profile.edge.max || profile.byteEdge.max || profile.read.max){
+		printf("resetRxProfile() didn't clear the measurements\n");
+		ok = false;
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+/**
+ * Sends random bursts of 1 to 6 messages of 1 to 30 bytes with sendMulti(), some of which overflow
+ * the receive buffer, and reads them after each burst with the reader given as the argument:
+ *   get    getReceivedData()
+ *   peek   peekReceivedData()/consumeReceivedData(), needs TRF_DATA_NATURAL_ORDER
+ *   drain  drainReceivedData() with room for 60 bytes and 3 messages per call
+ * Prints one line per message (error code, lost count, length and a hash of the data) so the
+ * output of the readers can be compared, `run.sh` fails if they differ. Exits with 1 if a reader
+ * misbehaves in a way that doesn't show in the output
+ * drain also checks that a message that is too long for its buffer doesn't hold up the others
+ * See README.md for how to build it
+**/
+
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+const int NUM_BURSTS = 40;
+
+//FNV-1a
+uint32_t hash_bytes(uint32_t hash, const byte data[], uint8_t len){
+	for(uint8_t i=0; i<len; i++){
+		hash = (hash ^ data[i]) * 16777619UL;
+	}
+	return hash;
+}
+
+void print_msg(uint8_t err, uint8_t numLost, uint8_t len, uint32_t hash){
+	printf("err %d, lost %d, len %d, hash %08lx\n", err, numLost, len, (unsigned long)hash);
+}
+
+//returns false if there was nothing left to read
+bool read_with_get(){
+	byte buf[40];
+	uint8_t numRcvdBytes = 0;
+	uint8_t numLost = 0;
+	uint8_t err = getReceivedData(buf, sizeof(buf), numRcvdBytes, numLost);
+	if(err == TRF_ERR_NO_DATA){
+		return false;
+	}
+	if(err != TRF_ERR_SUCCESS){
+		numRcvdBytes = 0;
+	}
+	print_msg(err, numLost, numRcvdBytes, hash_bytes(2166136261UL, buf, numRcvdBytes));
+	return true;
+}
+
+#ifdef TRF_DATA_NATURAL_ORDER
+int numSplit = 0;
+bool readerFailed = false;
+
+bool read_with_peek(){
+	TRFFrame frame;
+	uint8_t numLost = 0;
+	uint8_t err = peekReceivedData(frame, numLost);
+	if(err == TRF_ERR_NO_DATA){
+		return false;
+	}
+	if(err != TRF_ERR_SUCCESS){
+		print_msg(err, numLost, 0, 2166136261UL);
+		return true;
+	}
+	//peeking again has to return the same message
+	TRFFrame again;
+	if(peekReceivedData(again) != TRF_ERR_SUCCESS || again.data1 != frame.data1 || again.len1 != frame.len1){
+		readerFailed = true;
+	}
+	uint32_t hash = hash_bytes(2166136261UL, frame.data1, frame.len1);
+	hash = hash_bytes(hash, frame.data2, frame.len2);
+	numSplit += frame.len2 > 0;
+	//nothing is received while we read so the message can't be overwritten
+	if(!consumeReceivedData()){
+		readerFailed = true;
+	}
+	print_msg(err, numLost, frame.len1 + frame.len2, hash);
+	return true;
+}
+#endif
+
+bool read_with_drain(){
+	byte buf[60];
+	TRFMsgInfo msgs[3];
+	uint8_t numMsgs = drainReceivedData(buf, sizeof(buf), msgs, 3);
+	for(uint8_t i=0; i<numMsgs; i++){
+		print_msg(msgs[i].err, msgs[i].numLostMsgs, msgs[i].len,
+			hash_bytes(2166136261UL, &buf[msgs[i].offset], msgs[i].len));
+	}
+	return numMsgs > 0;
+}
+
+/**
+ * Sends messages of 6, 30, 5 and 8 bytes and drains them into a 10 byte buffer
+ * The 30 byte one has to be reported as TRF_ERR_BUFFER_OVERFLOW and the others received
+**/
+bool drain_skips_long_message(){
+	const uint8_t lens[] = {6, 30, 5, 8};
+	const uint8_t expectedErrs[] = {TRF_ERR_SUCCESS, TRF_ERR_BUFFER_OVERFLOW, TRF_ERR_SUCCESS, TRF_ERR_SUCCESS};
+	byte msg[30];
+	for(uint8_t k=0; k<sizeof(msg); k++){
+		msg[k] = k;
+	}
+	for(uint8_t len : lens){
+		send(msg, len);
+		sim_now += TX_DELAY_MICROS;
+	}
+
+	uint8_t numReceived = 0;
+	bool passed = true;
+	byte buf[10];
+	TRFMsgInfo msgs[4];
+	uint8_t numMsgs;
+	while((numMsgs = drainReceivedData(buf, sizeof(buf), msgs, 4)) > 0){
+		for(uint8_t i=0; i<numMsgs; i++){
+			uint8_t m = numReceived++;
+			if(m >= sizeof(lens) || msgs[i].err != expectedErrs[m]
+				|| msgs[i].len != (expectedErrs[m] == TRF_ERR_SUCCESS ? lens[m] : 0)){
+				passed = false;
+			}
+		}
+	}
+	passed &= numReceived == sizeof(lens);
+	fprintf(stderr, "a message too long for drain's buffer %s\n", passed ? "is skipped" : "is NOT skipped correctly");
+	return passed;
+}
+
+int main(int argc, char** argv){
+	const char* reader = argc > 1 ? argv[1] : "get";
+	bool (*read_one)() = NULL;
+	if(!strcmp(reader, "get")){
+		read_one = read_with_get;
+	}
+	else if(!strcmp(reader, "drain")){
+		read_one = read_with_drain;
+	}
+#ifdef TRF_DATA_NATURAL_ORDER
+	else if(!strcmp(reader, "peek")){
+		read_one = read_with_peek;
+	}
+#endif
+	if(read_one == NULL){
+		fprintf(stderr, "unknown or unavailable reader: %s\n", reader);
+		return 1;
+	}
+
+	setupReceiver(2);
+	setupTransmitter();
+	srand(5);
+
+	for(int b=0; b<NUM_BURSTS; b++){
+		int numMsgs = 1 + rand() % 6;
+		for(int i=0; i<numMsgs; i++){
+			byte msg[30];
+			uint8_t len = 1 + rand() % 30;
+			for(uint8_t k=0; k<len; k++){
+				msg[k] = rand();
+			}
+			sendMulti(msg, len, 1 + rand() % 3);
+			sim_now += TX_DELAY_MICROS;
+		}
+		while(read_one());
+	}
+
+	if(read_one == read_with_drain){
+		return drain_skips_long_message() ? 0 : 1;
+	}
+#ifdef TRF_DATA_NATURAL_ORDER
+	if(read_one == read_with_peek){
+		fprintf(stderr, "%d messages were split across the end of the buffer\n", numSplit);
+		return readerFailed ? 1 : 0;
+	}
+#endif
+	return 0;
+}
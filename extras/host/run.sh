@@ -0,0 +1,206 @@
+#!/bin/sh
+# builds and runs the host tests, see README.md
+
+cd "$(dirname "$0")/../.." || exit 1
+OUT=${TMPDIR:-/tmp}/trf_host
+mkdir -p "$OUT"
+CXX=${CXX:-g++}
+FLAGS="-std=gnu++11 -O2 -Wall -Wextra -Iextras/host -Isrc -Isrc/tiny"
+failed=0
+
+# TRF_BITRATE_2000 warns that an uncalibrated transmitter is too slow for it, the builds that use
+# one on purpose to show that turn the #warning off
+FAST_UNCALIBRATED="-DTRF_BITRATE_2000 -Wno-cpp"
+
+# build NAME SOURCE FLAGS...
+build(){
+	name=$1
+	src=$2
+	shift 2
+	$CXX $FLAGS "$@" "extras/host/$src" -o "$OUT/$name" || exit 1
+}
+
+echo "== skew, fixed windows (losses expected at the slow skews)"
+build skew_fixed skew_test.cpp $FAST_UNCALIBRATED
+"$OUT/skew_fixed"
+
+echo "== skew, TRF_RX_ADAPTIVE_THRESHOLDS"
+build skew_adaptive skew_test.cpp -DTRF_BITRATE_2000 -DTRF_RX_ADAPTIVE_THRESHOLDS
+"$OUT/skew_adaptive" || failed=1
+
+echo "== skew, TRF_LINE_CODE_MANCHESTER"
+build skew_manchester skew_test.cpp -DTRF_LINE_CODE_MANCHESTER
+build skew_manchester_2000 skew_test.cpp $FAST_UNCALIBRATED -DTRF_LINE_CODE_MANCHESTER
+build skew_manchester_2000_fec skew_test.cpp $FAST_UNCALIBRATED -DTRF_LINE_CODE_MANCHESTER -DTRF_FEC_HAMMING
+"$OUT/skew_manchester" || failed=1
+"$OUT/skew_manchester_2000" || failed=1
+"$OUT/skew_manchester_2000_fec" || failed=1
+
+echo "== skew, TRF_SYMBOLS_4LEVEL with a calibrated transmitter (+/-2%)"
+build skew_4level skew_test.cpp -DTRF_TX_CALIBRATED -DTRF_SYMBOLS_4LEVEL
+build skew_4level_2000 skew_test.cpp -DTRF_BITRATE_2000 -DTRF_TX_CALIBRATED -DTRF_SYMBOLS_4LEVEL
+build skew_4level_2000_fec skew_test.cpp -DTRF_BITRATE_2000 -DTRF_TX_CALIBRATED -DTRF_SYMBOLS_4LEVEL \
+	-DTRF_FEC_HAMMING
+"$OUT/skew_4level" 2 || failed=1
+"$OUT/skew_4level_2000" 2 || failed=1
+"$OUT/skew_4level_2000_fec" 2 || failed=1
+
+echo "== TRF_BITRATE_CUSTOM"
+build custom_1000 skew_test.cpp -DTRF_BITRATE_CUSTOM=1000
+build custom_1400 skew_test.cpp -DTRF_BITRATE_CUSTOM=1400
+build custom_4500_crystal skew_test.cpp -DTRF_BITRATE_CUSTOM=4500 -DTRF_TX_CRYSTAL
+build custom_manchester_2000 skew_test.cpp -DTRF_BITRATE_CUSTOM=2000 -DTRF_TX_CRYSTAL -DTRF_LINE_CODE_MANCHESTER
+build custom_4level_2000 skew_test.cpp -DTRF_BITRATE_CUSTOM=2000 -DTRF_TX_CRYSTAL -DTRF_SYMBOLS_4LEVEL
+"$OUT/custom_1000" 0 || failed=1
+"$OUT/custom_1400" 7 || failed=1
+"$OUT/custom_4500_crystal" 0 10 || failed=1
+"$OUT/custom_manchester_2000" 0 || failed=1
+"$OUT/custom_4level_2000" 0 || failed=1
+# the windows overlap at these rates, the static_asserts have to stop the build
+for opts in "-DTRF_BITRATE_CUSTOM=1500" "-DTRF_BITRATE_CUSTOM=5000 -DTRF_TX_CRYSTAL"; do
+	if $CXX $FLAGS $opts extras/host/skew_test.cpp -o "$OUT/custom_too_fast" 2>/dev/null; then
+		echo "$opts: compiled"
+		failed=1
+	else
+		echo "$opts: rejected"
+	fi
+done
+
+echo "== airtime per byte and airtimeMicros(), 1000 and 2000bps"
+build airtime airtime_bench.cpp -DTRF_TX_CALIBRATED
+build airtime_manchester airtime_bench.cpp -DTRF_TX_CALIBRATED -DTRF_LINE_CODE_MANCHESTER
+build airtime_4level airtime_bench.cpp -DTRF_TX_CALIBRATED -DTRF_SYMBOLS_4LEVEL
+build airtime_fec_eot airtime_bench.cpp -DTRF_TX_CALIBRATED -DTRF_FEC_HAMMING -DTRF_EOT_IN_TX
+build airtime_2000 airtime_bench.cpp -DTRF_BITRATE_2000 -DTRF_TX_CALIBRATED
+build airtime_4level_2000 airtime_bench.cpp -DTRF_BITRATE_2000 -DTRF_TX_CALIBRATED -DTRF_SYMBOLS_4LEVEL
+"$OUT/airtime" || failed=1
+"$OUT/airtime_manchester" || failed=1
+"$OUT/airtime_4level" || failed=1
+"$OUT/airtime_fec_eot" || failed=1
+"$OUT/airtime_2000" || failed=1
+"$OUT/airtime_4level_2000" || failed=1
+
+echo "== TRF_RX_ISR_ERR_CHK gives the same results (2000bps, skew 0.90-1.10)"
+for opts in "" "-DTRF_ERROR_CHECKING_CHECKSUM" "-DTRF_DATA_NATURAL_ORDER" "-DTRF_SEQ_DISABLED"; do
+	build err_chk err_chk_test.cpp $FAST_UNCALIBRATED $opts
+	build err_chk_isr err_chk_test.cpp $FAST_UNCALIBRATED -DTRF_RX_ISR_ERR_CHK $opts
+	"$OUT/err_chk" > "$OUT/err_chk.txt"
+	"$OUT/err_chk_isr" > "$OUT/err_chk_isr.txt"
+	if cmp -s "$OUT/err_chk.txt" "$OUT/err_chk_isr.txt"; then
+		echo "${opts:-CRC}: same, $(awk '{n+=$(NF-1)} END{print n}' "$OUT/err_chk.txt") corrupted"
+	else
+		echo "${opts:-CRC}: DIFFERENT"
+		failed=1
+	fi
+done
+
+echo "== sendMulti() repetitions"
+build dup dup_test.cpp
+build dup_isr_err_chk dup_test.cpp -DTRF_RX_ISR_ERR_CHK
+"$OUT/dup" || failed=1
+"$OUT/dup_isr_err_chk" || failed=1
+
+echo "== TRF_SENDER_ADDRESSING, 12 senders"
+build addr addr_test.cpp -DTRF_SENDER_ADDRESSING
+build addr_crc16 addr_test.cpp -DTRF_SENDER_ADDRESSING -DTRF_ERROR_CHECKING_CRC16
+build addr_checksum addr_test.cpp -DTRF_SENDER_ADDRESSING -DTRF_ERROR_CHECKING_CHECKSUM
+build addr_isr_err_chk addr_test.cpp -DTRF_SENDER_ADDRESSING -DTRF_RX_ISR_ERR_CHK
+"$OUT/addr" || failed=1
+"$OUT/addr_crc16" || failed=1
+"$OUT/addr_checksum" || failed=1
+"$OUT/addr_isr_err_chk" || failed=1
+
+echo "== send() and sendMulti()"
+build send send_test.cpp
+build send_async send_test.cpp -DTRF_TX_ASYNC
+build send_async_oc send_test.cpp -DTRF_TX_ASYNC -DTRF_TX_OUTPUT_COMPARE
+"$OUT/send" || failed=1
+"$OUT/send_async" || failed=1
+"$OUT/send_async_oc" || failed=1
+
+echo "== TRF_TX_ASYNC with late interrupts (losses expected without output compare)"
+build latency_isr tx_latency_test.cpp -DTRF_BITRATE_2000 -DTRF_TX_CRYSTAL -DTRF_TX_ASYNC
+build latency_oc tx_latency_test.cpp -DTRF_BITRATE_2000 -DTRF_TX_CRYSTAL -DTRF_TX_ASYNC -DTRF_TX_OUTPUT_COMPARE
+build latency_oc_manchester tx_latency_test.cpp -DTRF_BITRATE_2000 -DTRF_TX_CRYSTAL -DTRF_TX_ASYNC \
+	-DTRF_TX_OUTPUT_COMPARE -DTRF_LINE_CODE_MANCHESTER
+"$OUT/latency_isr"
+"$OUT/latency_oc" || failed=1
+"$OUT/latency_oc_manchester" || failed=1
+
+echo "== peekReceivedData() and drainReceivedData() return the same as getReceivedData()"
+for opts in "" "-DTRF_ERROR_CHECKING_CHECKSUM"; do
+	build reader reader_test.cpp -DTRF_DATA_NATURAL_ORDER $opts
+	"$OUT/reader" get > "$OUT/reader_get.txt" || failed=1
+	for reader in peek drain; do
+		"$OUT/reader" $reader > "$OUT/reader_$reader.txt" || failed=1
+		if cmp -s "$OUT/reader_get.txt" "$OUT/reader_$reader.txt"; then
+			echo "${opts:-CRC}, $reader: same, $(wc -l < "$OUT/reader_get.txt") messages"
+		else
+			echo "${opts:-CRC}, $reader: DIFFERENT"
+			failed=1
+		fi
+	done
+done
+
+echo "== buffer overflow"
+build overflow overflow_test.cpp
+"$OUT/overflow" || failed=1
+
+echo "== noise after every frame"
+build noise noise_test.cpp
+"$OUT/noise" || failed=1
+
+echo "== TRF_RX_FILTER, 64 byte buffer, half of the messages unwanted"
+build filter_none filter_test.cpp
+build filter_addr filter_test.cpp -DTRF_RX_FILTER -DTRF_SENDER_ADDRESSING
+build filter_content filter_test.cpp -DTRF_RX_FILTER
+"$OUT/filter_none"
+"$OUT/filter_addr" || failed=1
+"$OUT/filter_content" || failed=1
+
+echo "== TRF_RX_STATS"
+build stats stats_test.cpp -DTRF_RX_STATS
+build stats_isr_err_chk stats_test.cpp -DTRF_RX_STATS -DTRF_RX_ISR_ERR_CHK
+"$OUT/stats" || failed=1
+"$OUT/stats_isr_err_chk" || failed=1
+
+echo "== TRF_RX_PROFILE"
+build profile profile_test.cpp -DTRF_RX_PROFILE
+build profile_manchester profile_test.cpp -DTRF_RX_PROFILE -DTRF_LINE_CODE_MANCHESTER
+build profile_fec profile_test.cpp -DTRF_RX_PROFILE -DTRF_FEC_HAMMING
+build profile_input_capture profile_test.cpp -DTRF_RX_PROFILE -DTRF_RX_INPUT_CAPTURE
+build profile_eot_timer profile_test.cpp -DTRF_RX_PROFILE -DTRF_EOT_TIMER
+"$OUT/profile" || failed=1
+"$OUT/profile_manchester" || failed=1
+"$OUT/profile_fec" || failed=1
+
+echo "== TRF_RX_HISTOGRAM"
+build hist hist_test.cpp -DTRF_RX_HISTOGRAM
+build hist_manchester hist_test.cpp -DTRF_RX_HISTOGRAM -DTRF_LINE_CODE_MANCHESTER
+build hist_adaptive hist_test.cpp -DTRF_RX_HISTOGRAM -DTRF_RX_ADAPTIVE_THRESHOLDS
+build hist_4level hist_test.cpp -DTRF_RX_HISTOGRAM -DTRF_SYMBOLS_4LEVEL -DTRF_TX_CALIBRATED
+"$OUT/hist" || failed=1
+"$OUT/hist_manchester" || failed=1
+"$OUT/hist_adaptive" || failed=1
+"$OUT/hist_4level" 1.02 15 || failed=1
+
+echo "== goodput vs bit error rate"
+build fec_none fec_bench.cpp
+build fec_hamming fec_bench.cpp -DTRF_FEC_HAMMING
+"$OUT/fec_none"
+"$OUT/fec_hamming"
+
+echo "== crc8 variants"
+build crc8_bitwise crc8_bench.cpp
+build crc8_nibble crc8_bench.cpp -DTRF_CRC8_NIBBLE_TABLE
+build crc8_byte crc8_bench.cpp -DTRF_CRC8_BYTE_TABLE
+"$OUT/crc8_bitwise" || failed=1
+"$OUT/crc8_nibble" || failed=1
+"$OUT/crc8_byte" || failed=1
+
+echo "== undetected errors, checksum8 vs crc8 vs crc16"
+build crc_detect crc_detect_bench.cpp
+"$OUT/crc_detect"
+
+[ $failed = 0 ] && echo "PASSED" || echo "FAILED"
+exit $failed
@@ -0,0 +1,90 @@
+/**
+ * Checks what send() and sendMulti() accept: messages up to TRF_MAX_MSG_LEN, and with
+ * TRF_TX_ASYNC only the ones that fit in the send queue. Rejected messages must not be sent and
+ * must not use up a sequence number. With TRF_TX_ASYNC it also checks that queueing a message
+ * takes no time and that the completion callback runs once for every message
+ * Exits with 1 if any check fails
+ * See README.md for how to build it
+**/
+
+#include "Arduino.h"
+#ifdef TRF_TX_ASYNC
+	#include "avr_timer1.h"
+#endif
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+#ifdef TRF_SEQ_DISABLED
+	#error "The sequence number checks need sequence numbering."
+#endif
+
+bool passed = true;
+
+void check(const char* name, bool ok){
+	printf("%-56s %s\n", name, ok ? "ok" : "FAILED");
+	passed &= ok;
+}
+
+//sends 'len' bytes, and with TRF_TX_ASYNC waits for them to go out
+bool send_and_wait(byte data[], uint8_t len){
+	bool accepted = send(data, len);
+#ifdef TRF_TX_ASYNC
+	run_timer1(0);
+#endif
+	sim_now += TX_DELAY_MICROS;
+	return accepted;
+}
+
+//returns the length of the message that was received, 0 if there wasn't one
+uint8_t received_len(){
+	byte buf[TRF_MAX_MSG_LEN];
+	uint8_t numRcvdBytes = 0;
+	uint8_t len = 0;
+	while(getReceivedData(buf, sizeof(buf), numRcvdBytes) != TRF_ERR_NO_DATA){
+		len = numRcvdBytes;
+	}
+	return len;
+}
+
+#ifdef TRF_TX_ASYNC
+int numCallbacks = 0;
+
+void sent(){
+	numCallbacks++;
+}
+#endif
+
+int main(){
+	setupReceiver(2);
+	setupTransmitter();
+	byte msg[200];
+	for(uint8_t k=0; k<sizeof(msg); k++){
+		msg[k] = k + 1;
+	}
+
+	check("send() accepts 20 bytes", send_and_wait(msg, 20) && received_len() == 20);
+	uint8_t seqBefore = seq;
+	check("send() rejects TRF_MAX_MSG_LEN + 1 bytes", !send_and_wait(msg, TRF_MAX_MSG_LEN + 1) && received_len() == 0);
+	check("sendMulti() rejects TRF_MAX_MSG_LEN + 1 bytes", !sendMulti(msg, TRF_MAX_MSG_LEN + 1, 2));
+	check("rejected messages don't use up a sequence number", seq == seqBefore);
+
+#ifndef TRF_TX_ASYNC
+	check("send() accepts TRF_MAX_MSG_LEN bytes", send_and_wait(msg, TRF_MAX_MSG_LEN));
+#else
+	//each message takes its length + TRF_FRAME_OVERHEAD + 3 bytes of the queue
+	const uint8_t maxQueued = TRF_TX_BUFFER_SIZE - TRF_FRAME_OVERHEAD - 3;
+	check("send() accepts a message that fills the queue", send_and_wait(msg, maxQueued) && received_len() == maxQueued);
+	check("send() rejects a message one byte larger than the queue", !send_and_wait(msg, maxQueued + 1) && received_len() == 0);
+
+	setSendCallback(sent);
+	numCallbacks = 0;
+	unsigned long start = sim_now;
+	bool accepted = sendMulti(msg, 10, 2) && send(msg, 5);
+	check("sendMulti() and send() return without waiting", accepted && sim_now == start && isSending());
+	run_timer1(0);
+	check("the callback runs once for every message", numCallbacks == 2 && !isSending());
+#endif
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+/**
+ * Replays send()/sendMulti() through the receiver's interrupt routine with the transmitter's clock
+ * from 10% fast to 10% slow and +/-15us of jitter on every delay
+ * Prints how many messages were received at each skew, exits with 1 if any were lost
+ * An argument limits the skew to that many percent, e.g. 2 for a calibrated transmitter, a second one
+ * sets the jitter in us
+ * See README.md for how to build it
+**/
+
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+const double skews[] = {0.90, 0.93, 0.95, 0.98, 1.00, 1.02, 1.05, 1.07, 1.10};
+const char* msgs[] = {"Hello from far away!", "x", "abcdefghijklmnopqrstuvwxyz0123"};
+const int NUM_ROUNDS = 20;
+
+int main(int argc, char** argv){
+	double maxSkew = (argc > 1) ? atof(argv[1]) / 100 : 0.10;
+	setupReceiver(2);
+	setupTransmitter();
+	sim_jitter = (argc > 2) ? atoi(argv[2]) : 15;
+	srand(1);
+
+	bool allReceived = true;
+	for(double skew : skews){
+		if(skew < 1 - maxSkew - 0.001 || skew > 1 + maxSkew + 0.001){
+			continue;
+		}
+		sim_skew = skew;
+		int ok = 0;
+		int total = 0;
+		for(int r=0; r<NUM_ROUNDS; r++){
+			for(const char* msg : msgs){
+				uint8_t len = strlen(msg);
+				sendMulti((byte*)msg, len, 2);
+				sim_now += TX_DELAY_MICROS;
+				total++;
+				byte buf[40];
+				uint8_t numRcvdBytes;
+				uint8_t err;
+				while((err = getReceivedData(buf, sizeof(buf), numRcvdBytes)) != TRF_ERR_NO_DATA){
+					if(err == TRF_ERR_SUCCESS && numRcvdBytes == len && !memcmp(buf, msg, len)){
+						ok++;
+					}
+				}
+			}
+		}
+		printf("skew %.2f: %d/%d\n", skew, ok, total);
+		if(ok != total){
+			allReceived = false;
+		}
+	}
+
+	return allReceived ? 0 : 1;
+}
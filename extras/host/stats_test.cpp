@@ -0,0 +1,91 @@
+/**
+ * Sends a known mix of frames and checks the counters of TRF_RX_STATS:
+ * 6 messages 3 times each, a noise burst (a START pulse and 5 zeroes), and 3 messages with bit errors
+ * Prints the counters, exits with 1 if one of them doesn't match what was sent or if
+ * resetRxStats() doesn't zero them
+ * See README.md for how to build it
+**/
+
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+#ifndef TRF_RX_STATS
+	#error "Build with -DTRF_RX_STATS."
+#endif
+
+const uint8_t MSG_LEN = 30;
+
+void pulse(uint16_t period){
+	digitalWrite(0, HIGH);
+	delayMicroseconds(PERIOD_HIGH_DURATION);
+	digitalWrite(0, LOW);
+	delayMicroseconds(period - PERIOD_HIGH_DURATION);
+}
+
+int main(){
+	//bit errors swap the LOW parts of a 0 and a 1
+	sim_a = ONE_PULSE_PERIOD - PERIOD_HIGH_DURATION;
+	sim_b = ZERO_PULSE_PERIOD - PERIOD_HIGH_DURATION;
+	setupReceiver(2);
+	setupTransmitter();
+	srand(5);
+
+	byte msg[MSG_LEN];
+	for(uint8_t i=0; i<MSG_LEN; i++){
+		msg[i] = i + 1;
+	}
+	for(uint8_t i=0; i<6; i++){
+		msg[0] = i;
+		sendMulti(msg, MSG_LEN, 3);
+		sim_now += TX_DELAY_MICROS;
+	}
+	pulse(START_PULSE_PERIOD);
+	for(uint8_t i=0; i<5; i++){
+		pulse(ZERO_PULSE_PERIOD);
+	}
+	sim_now += TX_DELAY_MICROS;
+	sim_ber = 0.02;
+	for(uint8_t i=0; i<3; i++){
+		msg[0] = 10 + i;
+		send(msg, MSG_LEN);
+		sim_now += TX_DELAY_MICROS;
+	}
+	sim_ber = 0;
+
+	int numRead = 0;
+	byte buf[40];
+	uint8_t numRcvdBytes;
+	uint8_t err;
+	while((err = getReceivedData(buf, sizeof(buf), numRcvdBytes)) != TRF_ERR_NO_DATA){
+		if(err == TRF_ERR_SUCCESS){
+			numRead++;
+		}
+	}
+
+	TRFRxStats stats;
+	getRxStats(stats);
+	printf("edges=%u starts=%u frames=%u noise=%u corrupted=%u evictions=%u duplicates=%u highWater=%u\n",
+		stats.edges, stats.starts, stats.frames, stats.noise, stats.corrupted, stats.evictions,
+		stats.duplicates, stats.highWater);
+	printf("read %d intact messages\n", numRead);
+
+	//every frame that is stored is either read or evicted
+	//the ones with bit errors aren't stored with TRF_RX_ISR_ERR_CHK, otherwise they fail when read
+	bool ok = stats.starts == 22 && stats.duplicates == 12 && stats.noise == 1 && stats.corrupted == 3
+		&& stats.highWater <= TRF_RX_BUFFER_SIZE;
+#ifdef TRF_RX_ISR_ERR_CHK
+	ok = ok && stats.frames == 6 && numRead + stats.evictions == stats.frames;
+#else
+	ok = ok && stats.frames == 9 && numRead + stats.corrupted + stats.evictions == stats.frames;
+#endif
+
+	resetRxStats();
+	getRxStats(stats);
+	if(stats.edges || stats.starts || stats.frames || stats.noise || stats.corrupted || stats.evictions
+		|| stats.duplicates || stats.highWater){
+		printf("resetRxStats() didn't zero the counters\n");
+		ok = false;
+	}
+	return ok ? 0 : 1;
+}
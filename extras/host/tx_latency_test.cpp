@@ -0,0 +1,73 @@
+/**
+ * Sends messages with TRF_TX_ASYNC and runs every Timer1 compare interrupt a random 0..N us late,
+ * like another interrupt or a long cli() section would make it, and prints how many messages were
+ * received for each N. Without TRF_TX_OUTPUT_COMPARE the interrupt changes the pin so every edge
+ * is as late as the interrupt, with it the compare unit changes the pin on the match.
+ * The first message of each round queues the next one from its completion callback, which runs
+ * during the gap after the message
+ * Exits with 1 if any message was lost
+ * See README.md for how to build it
+**/
+
+#include "Arduino.h"
+#include "avr_timer1.h"
+#include "TinyRF_RX.h"
+#include "TinyRF_TX.h"
+#include "tiny/TinyRF.cpp"
+
+#ifndef TRF_TX_ASYNC
+	#error "Build it with TRF_TX_ASYNC."
+#endif
+
+const int latencies[] = {0, 10, 20, 30, 40, 50, 60};
+const char* msgs[] = {"Hello from far away!", "x", "abcdefghijklmnopqrstuvwxyz0123"};
+const int NUM_ROUNDS = 20;
+
+int numCallbacks = 0;
+
+void sent(){
+	numCallbacks++;
+	if(numCallbacks % 3 == 1){
+		sendMulti((byte*)msgs[1], strlen(msgs[1]), 2);
+	}
+}
+
+int main(){
+	setupReceiver(2);
+	setupTransmitter();
+	setSendCallback(sent);
+	srand(1);
+
+	bool allReceived = true;
+	for(int maxLatency : latencies){
+		int ok = 0;
+		int total = 0;
+		for(int r=0; r<NUM_ROUNDS; r++){
+			sendMulti((byte*)msgs[0], strlen(msgs[0]), 2);
+			run_timer1(maxLatency);
+			sendMulti((byte*)msgs[2], strlen(msgs[2]), 2);
+			run_timer1(maxLatency);
+			sim_now += TX_DELAY_MICROS;
+			total += 3;
+
+			//they have to come out in the order they were sent
+			byte buf[40];
+			uint8_t numRcvdBytes;
+			uint8_t err;
+			int m = 0;
+			while((err = getReceivedData(buf, sizeof(buf), numRcvdBytes)) != TRF_ERR_NO_DATA){
+				if(err == TRF_ERR_SUCCESS && m < 3 && numRcvdBytes == strlen(msgs[m])
+					&& !memcmp(buf, msgs[m], numRcvdBytes)){
+					ok++;
+				}
+				m++;
+			}
+		}
+		printf("interrupt latency 0..%dus: %d/%d\n", maxLatency, ok, total);
+		if(ok != total){
+			allReceived = false;
+		}
+	}
+
+	return allReceived ? 0 : 1;
+}
@@ -19,16 +19,16 @@ void send(uint16_t data)
     for(uint8_t i=0; i<10; i++)
     {
         // _sendBits(0xAAAA, 8);
-        digitalWrite(TX_PIN, HIGH);
+        TX_HIGH();
         _delay_us(DUR_ZERO + DUR_SPACE);
-        digitalWrite(TX_PIN, LOW);
+        TX_LOW();
         _delay_us(DUR_ZERO + DUR_SPACE);
     }
 
     // send start
-    digitalWrite(TX_PIN, HIGH);
+    TX_HIGH();
     _delay_us(DUR_START);
-    digitalWrite(TX_PIN, LOW);
+    TX_LOW();
     _delay_us(DUR_SPACE);
 
     // send crc
@@ -46,17 +46,17 @@ void _sendBits(uint16_t data, uint8_t numBits)
     {
         if (bitRead(data, txBitIndex))
         {
-            digitalWrite(TX_PIN, HIGH);
+            TX_HIGH();
             _delay_us(DUR_ONE);
-            digitalWrite(TX_PIN, LOW);
+            TX_LOW();
             _delay_us(DUR_SPACE);
         }
 
         else
         {
-            digitalWrite(TX_PIN, HIGH);
+            TX_HIGH();
             _delay_us(DUR_ZERO);
-            digitalWrite(TX_PIN, LOW);
+            TX_LOW();
             _delay_us(DUR_SPACE);
         }
 
@@ -5,6 +5,31 @@
 // it can still be changed from here to any pin
 #define TX_PIN 0
 
+// on boards where we know how pin numbers map to ports the pin is turned into a port and a bit at
+// compile time so each edge is a single sbi/cbi, on other boards we fall back to digitalWrite()
+// the mapping is done by the compiler and not with #if so TX_PIN can also be something like A0
+#if defined(__AVR_ATmega328__) || defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328PB__)
+	// pins 0-7 are on PORTD, 8-13 on PORTB and 14-19 (A0-A5) on PORTC
+	#define TX_PORT_MAPPED ((TX_PIN) < 20)
+	#define TX_PORT (*((TX_PIN) < 8 ? &PORTD : ((TX_PIN) < 14 ? &PORTB : &PORTC)))
+	#define TX_BIT ((TX_PIN) < 8 ? (TX_PIN) : ((TX_PIN) < 14 ? (TX_PIN) - 8 : (TX_PIN) - 14))
+#elif defined(__AVR_ATtiny13__) || defined(__AVR_ATtiny25__) || defined(__AVR_ATtiny45__) \
+	|| defined(__AVR_ATtiny85__)
+	// pin numbers are the same as PORTB bit numbers
+	#define TX_PORT_MAPPED ((TX_PIN) < 6)
+	#define TX_PORT PORTB
+	#define TX_BIT (TX_PIN)
+#endif
+
+#ifdef TX_PORT
+	// TX_PORT_MAPPED is a constant so the compiler only keeps one of the branches
+	#define TX_HIGH() do{ if(TX_PORT_MAPPED) TX_PORT |= (1 << (TX_BIT & 7)); else digitalWrite(TX_PIN, HIGH); }while(0)
+	#define TX_LOW() do{ if(TX_PORT_MAPPED) TX_PORT &= ~(1 << (TX_BIT & 7)); else digitalWrite(TX_PIN, LOW); }while(0)
+#else
+	#define TX_HIGH() digitalWrite(TX_PIN, HIGH)
+	#define TX_LOW() digitalWrite(TX_PIN, LOW)
+#endif
+
 void setupTransmitter();
 void send(uint16_t data);
 void _sendBits(uint16_t data, uint8_t numBits);
@@ -16,25 +16,62 @@ byte checksum8(byte data[], uint8_t len, uint8_t seq){
 	return (byte) ~sum;
 }
 
-//CRC-8 - based on the CRC8 formulas by Dallas/Maxim
-//code released under the therms of the GNU GPL 3.0 license
-byte crc8(byte data[], uint8_t len, uint8_t seq){
-	byte crc = seq;
+//the functions below are always compiled even when their settings are not enabled, because 
+//this file is compiled on its own with the settings in TinyRF_Settings.h and a sketch can enable
+//them before including TinyRF, unused functions are removed by the linker
+
+//CRC-16 with the 0x8005 polynomial (reversed 0xA001), the one used by MODBUS
+//computed 4 bits at a time with a 32 byte table
+const uint16_t crc16NibbleTable[16] PROGMEM = {
+	0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+	0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400
+};
+
+uint16_t crc16_update(uint16_t crc, byte extract){
+	crc = (crc >> 4) ^ pgm_read_word(&crc16NibbleTable[(crc ^ extract) & 0x0F]);
+	crc = (crc >> 4) ^ pgm_read_word(&crc16NibbleTable[(crc ^ (extract >> 4)) & 0x0F]);
+	return crc;
+}
+
+uint16_t crc16(byte data[], uint8_t len, uint16_t seq){
+	uint16_t crc = seq;
 	while (len--)
 	{
-		byte extract = *data++;
-		for (byte tempI = 8; tempI; tempI--)
-		{
-			byte sum = (crc ^ extract) & 0x01;
-			crc >>= 1;
-			if (sum)
-			{
-				crc ^= 0x8C;
-			}
-			extract >>= 1;
-		}
+		crc = crc16_update(crc, *data++);
 	}
 	return crc;
 }
 
+
+//Hamming(8,4) codewords, the low nibble is the data, bits 4-6 are parity bits and bit 7 makes
+//the number of 1s even. Any two codewords differ in at least 4 bits
+const byte hammingCodes[16] PROGMEM = {
+	0x00, 0xB1, 0xD2, 0x63, 0xE4, 0x55, 0x36, 0x87,
+	0x78, 0xC9, 0xAA, 0x1B, 0x9C, 0x2D, 0x4E, 0xFF
+};
+
+//which data bit is wrong for each syndrome, zero means a parity bit is wrong
+const byte hammingFixes[8] PROGMEM = {0, 0, 0, 0x01, 0, 0x02, 0x04, 0x08};
+
+byte hamming_encode(byte nibble){
+	return pgm_read_byte(&hammingCodes[nibble & 0x0F]);
+}
+
+byte hamming_decode(byte codeword){
+	byte nibble = codeword & 0x0F;
+	//the parity bits that don't match the data tell us which bit is wrong
+	byte syndrome = ((pgm_read_byte(&hammingCodes[nibble]) ^ codeword) >> 4) & 0x07;
+	if(syndrome){
+		//with one wrong bit the number of 1s is odd, with two it is even and we can't tell which
+		//bits are wrong, in that case we leave it as it is for error checking to catch
+		byte ones = codeword ^ (codeword >> 4);
+		ones ^= ones >> 2;
+		ones ^= ones >> 1;
+		if(ones & 0x01){
+			nibble ^= pgm_read_byte(&hammingFixes[syndrome]);
+		}
+	}
+	return nibble;
+}
+
 #endif /* TRF_TINY_CPP */
\ No newline at end of file
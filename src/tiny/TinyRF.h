@@ -26,6 +26,42 @@
 #endif
 
 
+/**
+ * Board detection
+**/
+#if defined(__AVR_ATtiny2313__) || defined(__AVR_ATtiny4313__)
+	#define TRF_MCU_TinyX313
+#elif defined(__AVR_ATtiny24__) || defined(__AVR_ATtiny44__) || defined(__AVR_ATtiny84__)
+	#define TRF_MCU_TinyX4
+#elif defined(__AVR_ATtiny25__) || defined(__AVR_ATtiny45__) || defined(__AVR_ATtiny85__)
+	#define TRF_MCU_TinyX5
+#elif defined(__AVR_ATtiny167__) || defined(__AVR_ATtiny87__)
+	#define TRF_MCU_TinyX7
+#elif defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) || defined(__AVR_ATmega328PB__) \
+	|| defined(__AVR_ATmega168__) || defined(__AVR_ATmega168P__) || defined(__AVR_ATmega88__)
+	#define TRF_MCU_MegaX8
+#elif defined(ESP8266) || defined(ESP32)
+	#define TRF_MCU_ESP
+#endif
+
+
+/**
+ * Timer1 settings
+ * Timer1 is used for TRF_RX_INPUT_CAPTURE, TRF_EOT_TIMER and TRF_TX_ASYNC
+ * They all run it free with a prescaler of 8 so they can be used together
+**/
+#if defined(TRF_RX_INPUT_CAPTURE) || defined(TRF_EOT_TIMER) || defined(TRF_TX_ASYNC)
+	//this is how many bits timer ticks are shifted to get microseconds
+	#if (F_CPU == 16000000L)
+		#define TRF_TIMER1_TICK_SHIFT 1
+	#elif (F_CPU == 8000000L)
+		#define TRF_TIMER1_TICK_SHIFT 0
+	#else
+		#error "Unsupported CPU frequency for Timer1."
+	#endif
+#endif
+
+
 #if defined(TRF_TX_UNCALIBRATED)
 	#define TRF_CALIB_ERROR 10
 #elif defined(TRF_TX_CALIBRATED)
@@ -35,10 +71,57 @@
 #endif
 
 
-#if defined(TRF_ERROR_CHECKING_CRC)
+#if defined(TRF_ERROR_CHECKING_CRC16) && defined(TRF_ERROR_CHECKING_CRC)
+	#error "Only one of TRF_ERROR_CHECKING_CRC and TRF_ERROR_CHECKING_CRC16 can be defined."
+#endif
+
+//TRF_ERR_CHK_SIZE is the number of error checking bytes in each frame
+#if defined(TRF_ERROR_CHECKING_CRC16)
+	#define TRF_ERR_CHK_FUNC crc16
+	#define TRF_ERR_CHK_TYPE uint16_t
+	#define TRF_ERR_CHK_SIZE 2
+#elif defined(TRF_ERROR_CHECKING_CRC)
 	#define TRF_ERR_CHK_FUNC crc8
+	#define TRF_ERR_CHK_TYPE byte
+	#define TRF_ERR_CHK_SIZE 1
 #elif defined(TRF_ERROR_CHECKING_CHECKSUM)
 	#define TRF_ERR_CHK_FUNC checksum8
+	#define TRF_ERR_CHK_TYPE byte
+	#define TRF_ERR_CHK_SIZE 1
+#else
+	#define TRF_ERR_CHK_SIZE 0
+#endif
+
+
+#if (TRF_RX_DUP_WINDOW < 1) || (TRF_RX_DUP_WINDOW > 128)
+	#error "TRF_RX_DUP_WINDOW has to be between 1 and 128."
+#endif
+
+//TRF_ADDR_SIZE is the number of sender address bytes in each frame
+//the address is sent before the seq# and error checking covers it by mixing it into the seq#, 
+//TRF_ERR_CHK_SEED() is what's given to the error checking function in place of the seq#
+#ifdef TRF_SENDER_ADDRESSING
+	#ifdef TRF_SEQ_DISABLED
+		#error "TRF_SENDER_ADDRESSING needs sequence numbering."
+	#endif
+	#define TRF_ADDR_SIZE 1
+	#if defined(TRF_ERROR_CHECKING_CRC16)
+		#define TRF_ERR_CHK_SEED(addr, seq) (((uint16_t)(addr) << 8) | (seq))
+	#elif defined(TRF_ERROR_CHECKING_CRC)
+		#define TRF_ERR_CHK_SEED(addr, seq) crc8_update((addr), (seq))
+	#else
+		#define TRF_ERR_CHK_SEED(addr, seq) ((byte)((addr) + (seq)))
+	#endif
+#else
+	#define TRF_ADDR_SIZE 0
+	#define TRF_ERR_CHK_SEED(addr, seq) (seq)
+#endif
+
+//number of bytes in each frame other than the 'len' byte and the data
+#ifdef TRF_SEQ_DISABLED
+	#define TRF_FRAME_OVERHEAD TRF_ERR_CHK_SIZE
+#else
+	#define TRF_FRAME_OVERHEAD (TRF_ERR_CHK_SIZE + TRF_ADDR_SIZE + 1)
 #endif
 
 
@@ -51,7 +134,7 @@
  * Also it will take more time to calculate the CRC, increasing transmission time and bugging down
  * the receiver CPU
 **/
-#define TRF_MAX_MSG_LEN TRF_RX_BUFFER_SIZE-5	//-5 to account for len, CRC, seq# and just to be safe
+#define TRF_MAX_MSG_LEN (TRF_RX_BUFFER_SIZE - 5 - TRF_ADDR_SIZE)	//-5 to account for len, CRC (up to 2 bytes), seq# and just to be safe
 
 
 
@@ -59,6 +142,7 @@
 //these numbers are magic numbers, do not change them
 //they use the power of magic to reduce memory usage
 //if you change them even slightly you will see that memory usage will increase
+//for other data rates use TRF_BITRATE_CUSTOM instead
 #ifdef TRF_BITRATE_200
 	const uint16_t START_PULSE_PERIOD = 5996;
 	const uint16_t ONE_PULSE_PERIOD = 3996;
@@ -90,7 +174,7 @@
 #endif
 
 #ifdef TRF_BITRATE_2000
-	#ifdef TRF_TX_UNCALIBRATED
+	#if defined(TRF_TX_UNCALIBRATED) && !defined(TRF_RX_ADAPTIVE_THRESHOLDS)
 		#warning "This data rate is too fast for an uncalibrated ATtiny."
 	#endif
 	const uint16_t START_PULSE_PERIOD = 1998;
@@ -102,22 +186,219 @@
 	const uint16_t NUM_PREAMBLE_BYTES = 30;
 #endif
 
+#ifdef TRF_BITRATE_CUSTOM
+	//calculated from the bitrate with the same proportions as the presets:
+	//the average of a 0 and a 1 is one bit, ZERO:ONE:START is 3:4:8 and the HIGH part is 2/3 of a 0
+	//the windows are checked below, if they overlap the bitrate is too fast for the TX clock
+	#ifndef TRF_LATENCY_BUDGET
+		#define TRF_LATENCY_BUDGET 30
+	#endif
+	static_assert(TRF_BITRATE_CUSTOM >= 200, "TRF_BITRATE_CUSTOM has to be at least 200.");
+	const uint16_t ZERO_PULSE_PERIOD = 6000000UL / 7 / TRF_BITRATE_CUSTOM;
+	const uint16_t ONE_PULSE_PERIOD = ZERO_PULSE_PERIOD * 4 / 3;
+	const uint16_t START_PULSE_PERIOD = 2 * ONE_PULSE_PERIOD;
+	const uint16_t PERIOD_HIGH_DURATION = ZERO_PULSE_PERIOD * 2 / 3;
+	const uint16_t TX_INTERVAL_CONST = 8000;
+	const uint16_t TRIGGER_ERROR = TRF_LATENCY_BUDGET;
+	//about 80ms of preamble like the presets
+	const uint16_t NUM_PREAMBLE_BYTES = (10000 + ZERO_PULSE_PERIOD - 1) / ZERO_PULSE_PERIOD;
+#endif
+
 const uint16_t ONE_PULSE_TRIGG_ERROR = (TRIGGER_ERROR + ONE_PULSE_PERIOD * TRF_CALIB_ERROR / 100);
 const uint16_t ZERO_PULSE_TRIGG_ERROR = (TRIGGER_ERROR + ZERO_PULSE_PERIOD * TRF_CALIB_ERROR / 100);
 const uint16_t START_PULSE_TRIGG_ERROR = (TRIGGER_ERROR + START_PULSE_PERIOD * TRF_CALIB_ERROR / 100);
 //for some reason longer delays are more inaccurate, so our start pulse maximum needs more leeway for error
 const uint16_t START_PULSE_MAX_ERROR = 2*START_PULSE_TRIGG_ERROR;
 
+#ifdef TRF_LINE_CODE_MANCHESTER
+	//half of a bit, which is the shortest pulse in manchester code
+	//we use the shortest pulse of the pulse period encoding (the LOW part of a 0) so that it works 
+	//just as well with the same modules
+	const uint16_t MANCHESTER_HALF_BIT = ZERO_PULSE_PERIOD - PERIOD_HIGH_DURATION;
+	//START is a HIGH this long, which is longer than anything in the data
+	const uint16_t MANCHESTER_START_DURATION = 4*MANCHESTER_HALF_BIT;
+	const uint16_t MANCHESTER_TRIGG_ERROR = (TRIGGER_ERROR + 2*MANCHESTER_HALF_BIT * TRF_CALIB_ERROR / 100);
+#endif
+
+#ifdef TRF_SYMBOLS_4LEVEL
+	#if defined(TRF_TX_UNCALIBRATED)
+		#error "TRF_SYMBOLS_4LEVEL needs a calibrated or crystal transmitter."
+	#endif
+	#if defined(TRF_LINE_CODE_MANCHESTER) || defined(TRF_RX_ADAPTIVE_THRESHOLDS)
+		#error "TRF_SYMBOLS_4LEVEL can't be used with TRF_LINE_CODE_MANCHESTER or TRF_RX_ADAPTIVE_THRESHOLDS."
+	#endif
+	//each pulse carries 2 bits, symbol 's' has a period of ZERO_PULSE_PERIOD + s*SYMBOL_STEP
+	//the step is the difference of ONE and ZERO but the longest symbol must stay well below START
+	const uint16_t SYMBOL_STEP = (ONE_PULSE_PERIOD - ZERO_PULSE_PERIOD) < (START_PULSE_PERIOD - ZERO_PULSE_PERIOD) / 4 ?
+		(ONE_PULSE_PERIOD - ZERO_PULSE_PERIOD) : (START_PULSE_PERIOD - ZERO_PULSE_PERIOD) / 4;
+	//anything outside these is noise
+	const uint16_t SYMBOL_MIN = ZERO_PULSE_PERIOD - SYMBOL_STEP/2;
+	const uint16_t SYMBOL_MAX = ZERO_PULSE_PERIOD + 3*SYMBOL_STEP + SYMBOL_STEP/2;
+#endif
+
+//make sure the receiver can tell the pulses apart
+//the only exception is TRF_BITRATE_2000 with an uncalibrated TX which only works with 
+//TRF_RX_ADAPTIVE_THRESHOLDS, there's a warning for it above
+#if !(defined(TRF_BITRATE_2000) && defined(TRF_TX_UNCALIBRATED))
+	#if defined(TRF_LINE_CODE_MANCHESTER)
+		static_assert(MANCHESTER_HALF_BIT + MANCHESTER_TRIGG_ERROR < 2*MANCHESTER_HALF_BIT - MANCHESTER_TRIGG_ERROR,
+			"Half and full manchester bits overlap, the bitrate is too fast.");
+		static_assert(2*MANCHESTER_HALF_BIT + MANCHESTER_TRIGG_ERROR < MANCHESTER_START_DURATION - 2*MANCHESTER_TRIGG_ERROR,
+			"Manchester bits and START overlap, the bitrate is too fast.");
+	#elif defined(TRF_SYMBOLS_4LEVEL)
+		static_assert(SYMBOL_STEP/2 > TRIGGER_ERROR + SYMBOL_MAX * TRF_CALIB_ERROR / 100,
+			"The 4 level symbols overlap, the bitrate is too fast.");
+		static_assert(SYMBOL_MAX < START_PULSE_PERIOD - START_PULSE_TRIGG_ERROR,
+			"The 4 level symbols and START overlap, the bitrate is too fast.");
+	#else
+		static_assert(ZERO_PULSE_PERIOD + ZERO_PULSE_TRIGG_ERROR < ONE_PULSE_PERIOD - ONE_PULSE_TRIGG_ERROR,
+			"0 and 1 pulses overlap, the bitrate is too fast for the TX calibration.");
+		static_assert(ONE_PULSE_PERIOD + ONE_PULSE_TRIGG_ERROR < START_PULSE_PERIOD - START_PULSE_TRIGG_ERROR,
+			"1 and START pulses overlap, the bitrate is too fast for the TX calibration.");
+	#endif
+#endif
+
+//each preamble byte is shorter with manchester code or 4 level symbols so we send more of them
+#if defined(TRF_LINE_CODE_MANCHESTER)
+	const uint16_t TX_PREAMBLE_BYTES = NUM_PREAMBLE_BYTES * 3 / 2;
+#elif defined(TRF_SYMBOLS_4LEVEL)
+	const uint16_t TX_PREAMBLE_BYTES = NUM_PREAMBLE_BYTES * 2;
+#else
+	const uint16_t TX_PREAMBLE_BYTES = NUM_PREAMBLE_BYTES;
+#endif
+
+//ratios of the ONE and START pulse periods to the ZERO pulse period in 8.8 fixed point
+//used by the receiver to scale the zero pulse period it measures during the preamble
+const uint16_t ONE_ZERO_RATIO = ((uint32_t)ONE_PULSE_PERIOD << 8) / ZERO_PULSE_PERIOD;
+const uint16_t START_ZERO_RATIO = ((uint32_t)START_PULSE_PERIOD << 8) / ZERO_PULSE_PERIOD;
+
 const uint16_t MIN_TX_INTERVAL_REAL = START_PULSE_PERIOD + START_PULSE_MAX_ERROR;
 //this is for end-user usage 
 const uint16_t TX_DELAY_MICROS = MIN_TX_INTERVAL_REAL * 2;
 
+//the length of each HIGH and LOW of the noise sent after a message with TRF_EOT_IN_TX
+#ifdef TRF_LINE_CODE_MANCHESTER
+	//half a bit is a valid manchester pulse so we make the noise shorter
+	const uint16_t TX_NOISE_DURATION = MANCHESTER_HALF_BIT/4;
+#else
+	const uint16_t TX_NOISE_DURATION = PERIOD_HIGH_DURATION/2;
+#endif
+
+//how long each part of a transmission takes in microseconds, bytes are the longest they can be
+#if defined(TRF_LINE_CODE_MANCHESTER)
+	const uint32_t TX_PREAMBLE_MICROS = (uint32_t)TX_PREAMBLE_BYTES * 16 * MANCHESTER_HALF_BIT;
+	const uint16_t TX_START_MICROS = MANCHESTER_START_DURATION + 2*MANCHESTER_HALF_BIT;
+	const uint16_t TX_BYTE_MAX_MICROS = 16 * MANCHESTER_HALF_BIT;
+#elif defined(TRF_SYMBOLS_4LEVEL)
+	const uint32_t TX_PREAMBLE_MICROS = (uint32_t)TX_PREAMBLE_BYTES * 4 * ZERO_PULSE_PERIOD;
+	const uint16_t TX_START_MICROS = START_PULSE_PERIOD;
+	const uint16_t TX_BYTE_MAX_MICROS = 4 * (ZERO_PULSE_PERIOD + 3*SYMBOL_STEP);
+#else
+	const uint32_t TX_PREAMBLE_MICROS = (uint32_t)TX_PREAMBLE_BYTES * 8 * ZERO_PULSE_PERIOD;
+	const uint16_t TX_START_MICROS = START_PULSE_PERIOD;
+	const uint16_t TX_BYTE_MAX_MICROS = 8 * ONE_PULSE_PERIOD;
+#endif
+#ifdef TRF_FEC_HAMMING
+	#define TRF_TX_BYTES_PER_BYTE 2
+#else
+	#define TRF_TX_BYTES_PER_BYTE 1
+#endif
+#if defined(TRF_EOT_IN_TX) && !defined(TRF_EOT_NONE)
+	const uint16_t TX_EOT_MICROS = 20 * TX_NOISE_DURATION;
+#else
+	const uint16_t TX_EOT_MICROS = 0;
+#endif
+
+//the longest time it takes to send a message of 'len' bytes with send(), in microseconds
+//1s take longer than 0s so messages with less 1s in them take less time, with manchester code 
+//it's always exactly this long
+//with sendMulti() each message after the first one also waits MIN_TX_INTERVAL_REAL + TX_INTERVAL_CONST
+constexpr uint32_t airtimeMicros(uint8_t len){
+	return TX_PREAMBLE_MICROS + TX_START_MICROS + TX_EOT_MICROS
+		+ (uint32_t)(len + 1 + TRF_FRAME_OVERHEAD) * TRF_TX_BYTES_PER_BYTE * TX_BYTE_MAX_MICROS;
+}
+
 
 /**
  * Function declarations
 **/
 byte checksum8(byte data[], uint8_t len, uint8_t seq = 0);
-byte crc8(byte data[], uint8_t len, uint8_t seq = 0);
+uint16_t crc16(byte data[], uint8_t len, uint16_t seq = 0);
+uint16_t crc16_update(uint16_t crc, byte extract);
+byte hamming_encode(byte nibble);
+byte hamming_decode(byte codeword);
+
+
+//CRC-8 - based on the CRC8 formulas by Dallas/Maxim
+//code released under the therms of the GNU GPL 3.0 license
+//it's defined here instead of TinyRF.cpp so that TRF_CRC8_NIBBLE_TABLE and TRF_CRC8_BYTE_TABLE
+//can be chosen in the sketch like the other settings, TinyRF.cpp is compiled on its own
+#if defined(TRF_CRC8_BYTE_TABLE)
+
+//the crc of every byte value starting from 0
+static const byte crc8Table[256] PROGMEM = {
+	0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83, 0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41,
+	0x9D, 0xC3, 0x21, 0x7F, 0xFC, 0xA2, 0x40, 0x1E, 0x5F, 0x01, 0xE3, 0xBD, 0x3E, 0x60, 0x82, 0xDC,
+	0x23, 0x7D, 0x9F, 0xC1, 0x42, 0x1C, 0xFE, 0xA0, 0xE1, 0xBF, 0x5D, 0x03, 0x80, 0xDE, 0x3C, 0x62,
+	0xBE, 0xE0, 0x02, 0x5C, 0xDF, 0x81, 0x63, 0x3D, 0x7C, 0x22, 0xC0, 0x9E, 0x1D, 0x43, 0xA1, 0xFF,
+	0x46, 0x18, 0xFA, 0xA4, 0x27, 0x79, 0x9B, 0xC5, 0x84, 0xDA, 0x38, 0x66, 0xE5, 0xBB, 0x59, 0x07,
+	0xDB, 0x85, 0x67, 0x39, 0xBA, 0xE4, 0x06, 0x58, 0x19, 0x47, 0xA5, 0xFB, 0x78, 0x26, 0xC4, 0x9A,
+	0x65, 0x3B, 0xD9, 0x87, 0x04, 0x5A, 0xB8, 0xE6, 0xA7, 0xF9, 0x1B, 0x45, 0xC6, 0x98, 0x7A, 0x24,
+	0xF8, 0xA6, 0x44, 0x1A, 0x99, 0xC7, 0x25, 0x7B, 0x3A, 0x64, 0x86, 0xD8, 0x5B, 0x05, 0xE7, 0xB9,
+	0x8C, 0xD2, 0x30, 0x6E, 0xED, 0xB3, 0x51, 0x0F, 0x4E, 0x10, 0xF2, 0xAC, 0x2F, 0x71, 0x93, 0xCD,
+	0x11, 0x4F, 0xAD, 0xF3, 0x70, 0x2E, 0xCC, 0x92, 0xD3, 0x8D, 0x6F, 0x31, 0xB2, 0xEC, 0x0E, 0x50,
+	0xAF, 0xF1, 0x13, 0x4D, 0xCE, 0x90, 0x72, 0x2C, 0x6D, 0x33, 0xD1, 0x8F, 0x0C, 0x52, 0xB0, 0xEE,
+	0x32, 0x6C, 0x8E, 0xD0, 0x53, 0x0D, 0xEF, 0xB1, 0xF0, 0xAE, 0x4C, 0x12, 0x91, 0xCF, 0x2D, 0x73,
+	0xCA, 0x94, 0x76, 0x28, 0xAB, 0xF5, 0x17, 0x49, 0x08, 0x56, 0xB4, 0xEA, 0x69, 0x37, 0xD5, 0x8B,
+	0x57, 0x09, 0xEB, 0xB5, 0x36, 0x68, 0x8A, 0xD4, 0x95, 0xCB, 0x29, 0x77, 0xF4, 0xAA, 0x48, 0x16,
+	0xE9, 0xB7, 0x55, 0x0B, 0x88, 0xD6, 0x34, 0x6A, 0x2B, 0x75, 0x97, 0xC9, 0x4A, 0x14, 0xF6, 0xA8,
+	0x74, 0x2A, 0xC8, 0x96, 0x15, 0x4B, 0xA9, 0xF7, 0xB6, 0xE8, 0x0A, 0x54, 0xD7, 0x89, 0x6B, 0x35
+};
+
+inline byte crc8_update(byte crc, byte extract){
+	return pgm_read_byte(&crc8Table[crc ^ extract]);
+}
+
+#elif defined(TRF_CRC8_NIBBLE_TABLE)
+
+//the crc of every 4 bit value starting from 0
+static const byte crc8NibbleTable[16] PROGMEM = {
+	0x00, 0x9D, 0x23, 0xBE, 0x46, 0xDB, 0x65, 0xF8, 0x8C, 0x11, 0xAF, 0x32, 0xCA, 0x57, 0xE9, 0x74
+};
+
+//crc is LSB first so the low nibble goes first
+inline byte crc8_update(byte crc, byte extract){
+	crc = (crc >> 4) ^ pgm_read_byte(&crc8NibbleTable[(crc ^ extract) & 0x0F]);
+	crc = (crc >> 4) ^ pgm_read_byte(&crc8NibbleTable[(crc ^ (extract >> 4)) & 0x0F]);
+	return crc;
+}
+
+#else
+
+inline byte crc8_update(byte crc, byte extract){
+	for (byte tempI = 8; tempI; tempI--)
+	{
+		byte sum = (crc ^ extract) & 0x01;
+		crc >>= 1;
+		if (sum)
+		{
+			crc ^= 0x8C;
+		}
+		extract >>= 1;
+	}
+	return crc;
+}
+
+#endif
+
+inline byte crc8(byte data[], uint8_t len, uint8_t seq = 0){
+	byte crc = seq;
+	while (len--)
+	{
+		crc = crc8_update(crc, *data++);
+	}
+	return crc;
+}
 
 
 #endif  /* TRF_TINY_H */ 
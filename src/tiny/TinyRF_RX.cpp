@@ -23,149 +23,650 @@ namespace tinyrf{
 	volatile bool interruptRun = false;
 	//efficient alternative to attachInterrupt/detachInterrupt
 	volatile bool interruptDisabled = false;
-	//buffer for received pulses(bits)
-	volatile unsigned long rcvdPulses[8];
 	//buffer for received bytes
+	//its size is a power of two so indexes are free running and wrapped with TRF_RX_BUF_MASK
 	volatile byte rcvdBytesBuf[TRF_RX_BUFFER_SIZE];
-	//index of rcvdBytesBuf to write the next byte in
+	//index of rcvdBytesBuf to write the next byte in, only changed by the interrupt
 	volatile uint8_t bufWriteIndex = 0;
-	//index of rcvdBytesBuf to read the next byte from
-	uint8_t bufReadIndex = 0;
-	//used to detect when bufWriteIndex is about to overwire bufReadIndex
-	volatile uint8_t bufsDiff = 0;
-	//whether buffer is being overwritten from the end, used when reading buffer
-	volatile boolean bufOverwriteOngoing = false;
+	//index of rcvdBytesBuf to read the next frame from
+	//the interrupt moves it forward when it overwrites the oldest frame
+	volatile uint8_t bufReadIndex = 0;
 	//the frame length as received in the first byte of the message
 	volatile uint8_t rcvdFrameLen = 0;
 	//the frame length as the number of actual bytes received since the transmission has begun
 	volatile uint8_t frameLen = 0;
+#ifdef TRF_FEC_HAMMING
+	//whether the first codeword of the current byte has been received
+	volatile bool rcvdHighNibble = false;
+	//the decoded first codeword of the current byte
+	volatile byte rcvdNibble = 0;
+#endif
 	//number of messages currently in buffer
 	volatile uint8_t numMsgsInBuffer = 0;
 	//beggining of the current message in buffer, the value of this will be the length of the message
 	volatile uint8_t msgAddrInBuf = 0;
 	//pin used for transmission, should support external interrupts
 	uint8_t rxPin = 2;
+#if defined(TRF_LINE_CODE_MANCHESTER) && !defined(TRF_MCU_ESP)
+	//input register and bit of rxPin, so the interrupt can read the pin without digitalRead()
+	volatile uint8_t *rxPinReg = NULL;
+	uint8_t rxPinMask = 0;
+#endif
+#ifdef TRF_RX_ISR_ERR_CHK
+	//running CRC or checksum of the frame being received, updated as each byte arrives
+	volatile uint16_t errChkState = 0;
+	//all data bytes of the frame being received OR'ed together, to detect all-zero noise
+	volatile byte dataBitsSet = 0;
+#endif
+#if !defined(TRF_SEQ_DISABLED) && !defined(TRF_SENDER_ADDRESSING)
+	//sequence number of the last message that was read from the buffer, -1 if none yet
+	int lastSeq = -1;
+#endif
+#ifndef TRF_SEQ_DISABLED
+	//beggining of the last frame that was put in the buffer, repeats of it aren't stored
+	volatile uint8_t lastFrameAddr = 0;
+	//false until there is a last frame, and once it has been overwritten by newer frames
+	volatile bool lastFrameIntact = false;
+	//whether every byte of the current frame so far is the same as the last frame
+	volatile bool sameAsLastFrame = false;
+#ifdef TRF_RX_ISR_ERR_CHK
+	//first error checking byte of the last frame, in the buffer it's replaced by the result
+	volatile byte lastFrameErrChk = 0;
+#endif
+#endif
+#ifdef TRF_DATA_NATURAL_ORDER
+	//address of the frame returned by peekReceivedData() that hasn't been consumed yet
+	volatile uint8_t peekedFrameAddr = 0;
+	//whether there is such a frame, cleared by the interrupt if it overwrites the frame
+	volatile bool peekPending = false;
+#endif
+#ifdef TRF_RX_FILTER
+	//decides which messages are kept, set with setReceiveFilter()
+	bool (*rxFilter)(uint8_t len, uint8_t senderAddr, byte firstByte) = NULL;
+#endif
+#ifdef TRF_RX_STATS
+	//counters returned by getRxStats(), written by the interrupt
+	TRFRxStats rxStats;
+#endif
+#ifdef TRF_RX_PROFILE
+	//running measurement of a duration, averages are kept as sum/count
+	typedef struct{
+		uint16_t min;
+		uint16_t max;
+		uint32_t sum;
+		uint16_t count;
+	} TRFTimeSum;
+	//interrupts that only decoded a pulse, ones that also completed a byte and getReceivedData()
+	TRFTimeSum edgeProf = {0xFFFF, 0, 0, 0};
+	TRFTimeSum byteEdgeProf = {0xFFFF, 0, 0, 0};
+	TRFTimeSum readProf = {0xFFFF, 0, 0, 0};
+	//set when the current interrupt has completed a byte
+	bool byteEdge = false;
+#endif
+#ifdef TRF_RX_HISTOGRAM
+	//number of pulses seen for each range of pulse periods, see RX_HIST_BIN_SHIFT
+	uint16_t rxHistogram[TRF_RX_HIST_BINS];
+#endif
+#ifdef TRF_SENDER_ADDRESSING
+	//the transmitters we have received messages from, and the seq# of the last message of each
+	uint8_t senderAddrs[TRF_RX_MAX_SENDERS];
+	uint8_t senderSeqs[TRF_RX_MAX_SENDERS];
+	//number of entries used, once they are all used the oldest one is replaced
+	uint8_t numSenders = 0;
+	uint8_t oldestSender = 0;
+#endif
+#ifdef TRF_RX_ADAPTIVE_THRESHOLDS
+	//decision boundaries for the current frame
+	//these are scaled from the zero pulse period measured during the preamble
+	uint16_t startMin = START_PULSE_PERIOD - START_PULSE_TRIGG_ERROR;
+	uint16_t startMax = START_PULSE_PERIOD + START_PULSE_MAX_ERROR;
+	uint16_t oneMin = ONE_PULSE_PERIOD - ONE_PULSE_TRIGG_ERROR;
+	uint16_t oneMax = ONE_PULSE_PERIOD + ONE_PULSE_TRIGG_ERROR;
+	uint16_t zeroMin = ZERO_PULSE_PERIOD - ZERO_PULSE_TRIGG_ERROR;
+	uint16_t zeroMax = ZERO_PULSE_PERIOD + ZERO_PULSE_TRIGG_ERROR;
+#endif
 
 }
 
-void lim_inc(volatile uint8_t &num){
-  //reset if it has reached max value
-  if(num == TRF_RX_BUFFER_SIZE - 1){
-    num = 0;
-  }
-  else{
-    num++;
-  }
+//decision boundaries used by process_pulse()
+#ifdef TRF_RX_ADAPTIVE_THRESHOLDS
+	#define TRF_START_MIN tinyrf::startMin
+	#define TRF_START_MAX tinyrf::startMax
+	#define TRF_ONE_MIN tinyrf::oneMin
+	#define TRF_ONE_MAX tinyrf::oneMax
+	#define TRF_ZERO_MIN tinyrf::zeroMin
+	#define TRF_ZERO_MAX tinyrf::zeroMax
+#else
+	#define TRF_START_MIN (START_PULSE_PERIOD - START_PULSE_TRIGG_ERROR)
+	#define TRF_START_MAX (START_PULSE_PERIOD + START_PULSE_MAX_ERROR)
+	#define TRF_ONE_MIN (ONE_PULSE_PERIOD - ONE_PULSE_TRIGG_ERROR)
+	#define TRF_ONE_MAX (ONE_PULSE_PERIOD + ONE_PULSE_TRIGG_ERROR)
+	#define TRF_ZERO_MIN (ZERO_PULSE_PERIOD - ZERO_PULSE_TRIGG_ERROR)
+	#define TRF_ZERO_MAX (ZERO_PULSE_PERIOD + ZERO_PULSE_TRIGG_ERROR)
+#endif
+
+//counts an event in rxStats, nothing without TRF_RX_STATS
+//the counters are 16 bits and also written by the interrupt, so outside of it we need
+//TRF_STATS_INC_MAIN which does the increment with interrupts off
+#ifdef TRF_RX_STATS
+	#define TRF_STATS_INC(counter) (tinyrf::rxStats.counter++)
+	#define TRF_STATS_INC_MAIN(counter) do{ noInterrupts(); tinyrf::rxStats.counter++; interrupts(); }while(0)
+#else
+	#define TRF_STATS_INC(counter)
+	#define TRF_STATS_INC_MAIN(counter)
+#endif
+
+//reads the level of the receiver pin, straight from its input register except on ESP
+#ifdef TRF_MCU_ESP
+	#define TRF_RX_READ() (digitalRead(tinyrf::rxPin) == HIGH)
+#else
+	#define TRF_RX_READ() ((*tinyrf::rxPinReg & tinyrf::rxPinMask) != 0)
+#endif
+
+//marks the interrupt as one that completed a byte, nothing without TRF_RX_PROFILE
+#ifdef TRF_RX_PROFILE
+	#define TRF_PROFILE_BYTE_EDGE() (tinyrf::byteEdge = true)
+#else
+	#define TRF_PROFILE_BYTE_EDGE()
+#endif
+
+
+#ifdef TRF_RX_PROFILE
+
+/**
+ * Adds one measured duration to 'prof'
+ * Before the sum can overflow both the sum and the count are halved, so the average keeps up with 
+ * recent measurements instead of getting stuck
+**/
+inline void profile_add(tinyrf::TRFTimeSum &prof, uint16_t duration){
+	if(duration < prof.min){
+		prof.min = duration;
+	}
+	if(duration > prof.max){
+		prof.max = duration;
+	}
+	prof.sum += duration;
+	if(++prof.count == 0x8000){
+		prof.sum >>= 1;
+		prof.count >>= 1;
+	}
 }
 
-void lim_sum(volatile uint8_t &num, uint16_t c){
-  c = c % TRF_RX_BUFFER_SIZE;
-  //reset if it has reached max value
-  int sum = num + c;
-  if( sum >= TRF_RX_BUFFER_SIZE ){
-    num = sum - TRF_RX_BUFFER_SIZE;
-  }
-  else{
-    num += c;
-  }
+/**
+ * Called at the end of the interrupt, 'start' is the time the interrupt started
+**/
+inline void profile_edge(uint16_t start){
+	using namespace tinyrf;
+	uint16_t duration = TRF_PROFILE_CLOCK() - start;
+	if(byteEdge){
+		byteEdge = false;
+		profile_add(byteEdgeProf, duration);
+	}
+	else{
+		profile_add(edgeProf, duration);
+	}
 }
 
-void lim_dec(volatile uint8_t &num){
-  //reset if it has reached min value
-  if(num == 0){
-    num = TRF_RX_BUFFER_SIZE - 1;
-  }
-  else{
-    num--;
-  }
+/**
+ * Called at the end of getReceivedData(), 'start' is the time it was called
+ * The interrupt doesn't touch readProf so we don't need to disable it
+**/
+inline void profile_read(uint16_t start){
+	profile_add(tinyrf::readProf, TRF_PROFILE_CLOCK() - start);
 }
 
-void lim_sub(volatile uint8_t &num, uint16_t c){
-  c = c % TRF_RX_BUFFER_SIZE;
-  int sub = num - c;
-  //reset if it has reached min value
-  if( sub < 0 ){
-    num = TRF_RX_BUFFER_SIZE - c + num;
-  }
-  else{
-    num -= c;
-  }
+#endif	/* TRF_RX_PROFILE */
+
+
+#ifdef TRF_RX_HISTOGRAM
+
+/**
+ * Counts one pulse period in the histogram, called from the interrupt
+ * It's just a shift and an increment so it doesn't change the timing of the receiver
+ * The counts stop at their maximum instead of wrapping around
+**/
+inline void hist_add(uint16_t pulsePeriod){
+	using namespace tinyrf;
+	uint16_t bin = pulsePeriod >> RX_HIST_BIN_SHIFT;
+	if(bin > TRF_RX_HIST_BINS - 1){
+		bin = TRF_RX_HIST_BINS - 1;
+	}
+	if(rxHistogram[bin] != 0xFFFF){
+		rxHistogram[bin]++;
+	}
 }
 
+#endif	/* TRF_RX_HISTOGRAM */
+
+inline void setup_rx_pin(){
+	using namespace tinyrf;
+	pinMode(rxPin, INPUT);
+#if defined(TRF_LINE_CODE_MANCHESTER) && !defined(TRF_MCU_ESP)
+	rxPinReg = portInputRegister(digitalPinToPort(rxPin));
+	rxPinMask = digitalPinToBitMask(rxPin);
+#endif
+}
 
 void setupReceiver(uint8_t pin){
 	using namespace tinyrf;
 	rxPin = pin;
-	pinMode(rxPin, INPUT);
+#if defined(TRF_RX_INPUT_CAPTURE) || defined(TRF_EOT_TIMER)
+	//the transmitter might be using Timer1 too, so we only change the bits we need
+	//the Arduino core puts it in PWM mode which we have to undo, the COM1A bits are left alone
+	cli();
+	TCCR1A &= ~((1 << WGM11) | (1 << WGM10));		// normal mode
+	TCCR1B &= ~((1 << WGM13) | (1 << WGM12) | (1 << CS12) | (1 << CS10));
+	TCCR1B |= (1 << CS11);		// prescaler 8
+	sei();
+#endif
+
+#ifdef TRF_RX_INPUT_CAPTURE
+	//the receiver has to be connected to ICP1, 'pin' is ignored
+	rxPin = TRF_ICP_PIN;
+	setup_rx_pin();
+
+	cli();
+	TCCR1B |= (1 << ICNC1);		// noise canceler, adds a constant 4 cycle delay
+	TCCR1B &= ~(1 << ICES1);	// capture on falling edge
+	TIFR1 = (1 << ICF1) | (1 << TOV1);	// clear any pending flags
+	TIMSK1 |= (1 << ICIE1) | (1 << TOIE1);	// enable capture and overflow interrupts
+	sei();
+#else
+	setup_rx_pin();
+#ifdef TRF_LINE_CODE_MANCHESTER
+	attachInterrupt(digitalPinToInterrupt(rxPin), interrupt_routine, CHANGE);
+#else
 	attachInterrupt(digitalPinToInterrupt(rxPin), interrupt_routine, FALLING);
+#endif
+#endif
 }
 
 
 inline void incBufWriteIndex(){
 	using namespace tinyrf;
-	lim_inc(bufWriteIndex);
-	lim_inc(bufsDiff);
-	//if incrementing bufsDiff causes it to reset to zero it means it has reached the bufReadIndex
+	bufWriteIndex++;
+	//if bufWriteIndex is a whole buffer ahead of bufReadIndex it has reached the oldest frame
 	//so we move bufReadIndex one frame forward
-	if(bufsDiff == 0){
-		bufOverwriteOngoing = true;
-		uint8_t emptiedBytes = rcvdBytesBuf[bufReadIndex] + 1;
+	if( (uint8_t)(bufWriteIndex - bufReadIndex) == TRF_RX_BUFFER_SIZE ){
+	#ifndef TRF_SEQ_DISABLED
+		//the last frame is about to be overwritten, the frames after it have nothing to compare to
+		if(bufReadIndex == lastFrameAddr){
+			lastFrameIntact = false;
+		}
+	#endif
+	#ifdef TRF_DATA_NATURAL_ORDER
+		//a new frame could later land at the same address, it must not be taken for the peeked one
+		if(bufReadIndex == peekedFrameAddr){
+			peekPending = false;
+		}
+	#endif
+		bufReadIndex += rcvdBytesBuf[bufReadIndex & TRF_RX_BUF_MASK] + 1;
 		numMsgsInBuffer--;
-		lim_sum(bufReadIndex, emptiedBytes);
-		lim_sub(bufsDiff, emptiedBytes);
-		bufOverwriteOngoing = false;
+		TRF_STATS_INC(evictions);
 	}
+#ifdef TRF_RX_STATS
+	uint8_t used = bufWriteIndex - bufReadIndex;
+	if(used > rxStats.highWater){
+		rxStats.highWater = used;
+	}
+#endif
 }
 
 
+#ifndef TRF_SEQ_DISABLED
+/**
+ * Returns byte 'pos' of the last frame that was put in the buffer, 0 being the 'len' byte
+**/
+inline byte last_frame_byte(uint8_t pos){
+	using namespace tinyrf;
+#ifdef TRF_RX_ISR_ERR_CHK
+	//its first error checking byte has been replaced by the result of the check
+	if(pos == 1){
+		return lastFrameErrChk;
+	}
+#endif
+	return rcvdBytesBuf[(lastFrameAddr + pos) & TRF_RX_BUF_MASK];
+}
+#endif
+
+
+#ifdef TRF_RX_ADAPTIVE_THRESHOLDS
+
+/**
+ * Scales the decision boundaries using the measured zero pulse period
+ * The measured period already includes the transmitter's clock error, so instead of padding the 
+ * windows by TRF_CALIB_ERROR we split the gap between the 0 and 1 pulse periods in half
+ * This way the windows never overlap no matter how fast or slow the transmitter's clock is
+**/
+inline void set_thresholds(uint16_t zeroPeriod){
+	using namespace tinyrf;
+	uint16_t onePeriod = ((uint32_t)zeroPeriod * ONE_ZERO_RATIO) >> 8;
+	uint16_t startPeriod = ((uint32_t)zeroPeriod * START_ZERO_RATIO) >> 8;
+	uint16_t halfGap = (onePeriod - zeroPeriod) >> 1;
+	zeroMin = zeroPeriod - halfGap;
+	zeroMax = zeroPeriod + halfGap;
+	oneMin = onePeriod - halfGap;
+	oneMax = onePeriod + halfGap;
+	//longer delays are more inaccurate so START gets more leeway, same as the fixed windows
+	startMin = startPeriod - 2*TRIGGER_ERROR;
+	startMax = startPeriod + 4*TRIGGER_ERROR;
+}
+
+/**
+ * Puts back the fixed decision boundaries
+ * Called on EOT so a frame whose preamble we missed is decoded with the fixed windows instead of 
+ * the ones learned from the previous transmitter
+**/
+inline void reset_thresholds(){
+	using namespace tinyrf;
+	startMin = START_PULSE_PERIOD - START_PULSE_TRIGG_ERROR;
+	startMax = START_PULSE_PERIOD + START_PULSE_MAX_ERROR;
+	oneMin = ONE_PULSE_PERIOD - ONE_PULSE_TRIGG_ERROR;
+	oneMax = ONE_PULSE_PERIOD + ONE_PULSE_TRIGG_ERROR;
+	zeroMin = ZERO_PULSE_PERIOD - ZERO_PULSE_TRIGG_ERROR;
+	zeroMax = ZERO_PULSE_PERIOD + ZERO_PULSE_TRIGG_ERROR;
+}
+
+/**
+ * Called for every pulse while no transmission is ongoing
+ * The preamble is all zero bytes, so every 8 consecutive zero pulses we average them and use
+ * the result as the zero pulse period of the upcoming frame
+ * This uses the fixed (wide) zero window, because we don't know the transmitter's clock yet
+**/
+inline void learn_preamble(uint16_t pulsePeriod){
+	static uint16_t sum = 0;
+	static uint8_t count = 0;
+	if( 
+		pulsePeriod > (ZERO_PULSE_PERIOD - ZERO_PULSE_TRIGG_ERROR)
+		&& pulsePeriod < (ZERO_PULSE_PERIOD + ZERO_PULSE_TRIGG_ERROR)
+	){
+		sum += pulsePeriod;
+		count++;
+		if(count == 8){
+			set_thresholds(sum >> 3);
+			sum = 0;
+			count = 0;
+		}
+	}
+	else{
+		sum = 0;
+		count = 0;
+	}
+}
+
+#endif	/* TRF_RX_ADAPTIVE_THRESHOLDS */
+
+
 /**
  * This function is called when end of transmission is detected either through interrupt or 
  * getReceivedData()
 **/
+#ifdef TRF_RX_ISR_ERR_CHK
+
+#if defined(TRF_ERROR_CHECKING_CRC) && !defined(TRF_DATA_NATURAL_ORDER)
+/**
+ * Undoes one byte of crc8(), so that crc8_undo(crc8_update(crc, b), b) == crc
+ * This is done bit by bit regardless of TRF_CRC8_NIBBLE_TABLE/TRF_CRC8_BYTE_TABLE
+ * The data comes in reverse, so we start from the received CRC and undo the bytes as they
+ * arrive. If the frame is intact we end up with the value crc8() started with, which is the seq#
+ * Every step of crc8() shifts right and XORs 0x8C, which has its top bit set, so the top bit
+ * of the result tells us whether the XOR happened
+**/
+inline byte crc8_undo(byte crc, byte extract){
+	for(byte tempI = 8; tempI; tempI--){
+		byte sum = crc >> 7;
+		if(sum){
+			crc ^= 0x8C;
+		}
+		crc = (crc << 1) | (sum ^ (extract >> 7));
+		extract <<= 1;
+	}
+	return crc;
+}
+#elif defined(TRF_ERROR_CHECKING_CRC16) && !defined(TRF_DATA_NATURAL_ORDER)
+//same as crc8_undo() for crc16(), 0xA001 also has its top bit set
+inline uint16_t crc16_undo(uint16_t crc, byte extract){
+	for(byte tempI = 8; tempI; tempI--){
+		byte sum = crc >> 15;
+		if(sum){
+			crc ^= 0xA001;
+		}
+		crc = (crc << 1) | (sum ^ (extract >> 7));
+		extract <<= 1;
+	}
+	return crc;
+}
+#endif
+
+#if defined(TRF_ERROR_CHECKING_CRC16)
+	#define TRF_CRC_UPDATE crc16_update
+	#define TRF_CRC_UNDO crc16_undo
+#else
+	#define TRF_CRC_UPDATE crc8_update
+	#define TRF_CRC_UNDO crc8_undo
+#endif
+
+/**
+ * Feeds one received byte to the running error check
+ * 'frameLen' is the position of the byte in the frame, 0 being the 'len' byte
+**/
+inline void update_err_chk(byte rcvdByte){
+	using namespace tinyrf;
+	if(frameLen <= TRF_ERR_CHK_SIZE){
+		//the error checking byte(s), the error checking functions use 0 as seq# if it's disabled
+		if(frameLen == 1){
+			dataBitsSet = 0;
+			errChkState = 0;
+		#if defined(TRF_ERROR_CHECKING_CHECKSUM) && defined(TRF_SEQ_DISABLED)
+			errChkState += 0xFF;
+		#endif
+		}
+	#if !defined(TRF_ERROR_CHECKING_CHECKSUM) && !defined(TRF_DATA_NATURAL_ORDER)
+		errChkState = (errChkState << 8) | rcvdByte;
+	#endif
+	}
+#ifdef TRF_SENDER_ADDRESSING
+	else if(frameLen == TRF_ERR_CHK_SIZE + 1){
+		//the address, it goes into the error check together with the seq#
+	}
+#endif
+#ifndef TRF_SEQ_DISABLED
+	else if(frameLen == TRF_ERR_CHK_SIZE + TRF_ADDR_SIZE + 1){
+	#if defined(TRF_ERROR_CHECKING_CHECKSUM) || defined(TRF_DATA_NATURAL_ORDER)
+		//the address isn't in the buffer if the frame is the same as the last one so far
+		TRF_ERR_CHK_TYPE seed = TRF_ERR_CHK_SEED((sameAsLastFrame ? last_frame_byte(frameLen - 1) 
+			: rcvdBytesBuf[(msgAddrInBuf + frameLen - 1) & TRF_RX_BUF_MASK]), rcvdByte);
+	#endif
+	#if defined(TRF_ERROR_CHECKING_CHECKSUM)
+		errChkState += (~seed & 0xFF);
+	#elif defined(TRF_DATA_NATURAL_ORDER)
+		errChkState = seed;
+	#endif
+	}
+#endif
+	else{
+		dataBitsSet |= rcvdByte;
+	#if defined(TRF_ERROR_CHECKING_CHECKSUM)
+		errChkState += (~rcvdByte & 0xFF);
+	#elif defined(TRF_DATA_NATURAL_ORDER)
+		errChkState = TRF_CRC_UPDATE(errChkState, rcvdByte);
+	#else
+		errChkState = TRF_CRC_UNDO(errChkState, rcvdByte);
+	#endif
+	}
+}
+
+/**
+ * Called on EOT, returns the result of error checking the frame that has just been received
+ * This is stored in place of the error checking byte, so reading the frame doesn't need to do it
+**/
+inline byte err_chk_result(){
+	using namespace tinyrf;
+	//we don't reject frames that were cut short, the 'len' byte might have been the corrupted one
+	//and the bytes we have are the whole message, error checking decides
+	TRF_ERR_CHK_TYPE errChckRcvd = rcvdBytesBuf[(msgAddrInBuf + 1) & TRF_RX_BUF_MASK];
+#ifdef TRF_ERROR_CHECKING_CRC16
+	errChckRcvd = (errChckRcvd << 8) | rcvdBytesBuf[(msgAddrInBuf + 2) & TRF_RX_BUF_MASK];
+#endif
+#if defined(TRF_ERROR_CHECKING_CHECKSUM)
+	uint16_t sum = (errChkState & 0xFF) + (errChkState >> 8);
+	bool passed = (errChckRcvd == (byte)~sum);
+#elif defined(TRF_DATA_NATURAL_ORDER)
+	bool passed = (errChckRcvd == errChkState);
+#elif defined(TRF_SEQ_DISABLED)
+	bool passed = (errChkState == 0);
+#else
+	bool passed = (errChkState == (TRF_ERR_CHK_TYPE)TRF_ERR_CHK_SEED(
+		rcvdBytesBuf[(msgAddrInBuf + 1 + TRF_ERR_CHK_SIZE) & TRF_RX_BUF_MASK],
+		rcvdBytesBuf[(msgAddrInBuf + 1 + TRF_ERR_CHK_SIZE + TRF_ADDR_SIZE) & TRF_RX_BUF_MASK]));
+#endif
+	if(!passed){
+		return TRF_ERR_CORRUPTED;
+	}
+	//if all data is zeroes CRC will also be zero and CRC check will pass
+	if(errChckRcvd == 0 && dataBitsSet == 0){
+		return TRF_ERR_NOISE;
+	}
+	return TRF_ERR_SUCCESS;
+}
+
+#endif	/* TRF_RX_ISR_ERR_CHK */
+
+
 inline void EOT(){
 	using namespace tinyrf;
 	transmitOngoing = false;
+#ifdef TRF_RX_ADAPTIVE_THRESHOLDS
+	reset_thresholds();
+#endif
+	//a frame that is too short to hold any data is noise, e.g. a START followed by garbage
+	//we free its bytes right away instead of keeping it until getReceivedData() throws it away
+	//this way noise never pushes good frames out of the buffer
+	if(frameLen - 1 < TRF_MIN_FRAME_LEN){
+		bufWriteIndex = msgAddrInBuf;
+		TRF_STATS_INC(noise);
+		return;
+	}
+#ifndef TRF_SEQ_DISABLED
+	//a frame that is byte for byte the same as the last one, seq# and error checking included,
+	//is a repeat sent by sendMulti(). its bytes were only compared and never stored, see 
+	//process_received_byte(), so there is nothing to free. a repeat that was cut short is also 
+	//dropped since we already have the whole frame
+	if(sameAsLastFrame){
+		TRF_STATS_INC(duplicates);
+		return;
+	}
+#endif
+#ifdef TRF_RX_ISR_ERR_CHK
+	//noise and corrupted frames are thrown away before they take up buffer space, so the frames
+	//that are stored have all passed error checking
+	byte errChkResult = err_chk_result();
+	if(errChkResult != TRF_ERR_SUCCESS){
+		bufWriteIndex = msgAddrInBuf;
+	#ifdef TRF_RX_STATS
+		if(errChkResult == TRF_ERR_NOISE){
+			rxStats.noise++;
+		}
+		else{
+			rxStats.corrupted++;
+		}
+	#endif
+		return;
+	}
+	#ifndef TRF_SEQ_DISABLED
+		lastFrameErrChk = rcvdBytesBuf[(msgAddrInBuf + 1) & TRF_RX_BUF_MASK];
+	#endif
+	rcvdBytesBuf[(msgAddrInBuf + 1) & TRF_RX_BUF_MASK] = errChkResult;
+#endif
+#ifndef TRF_SEQ_DISABLED
+	lastFrameAddr = msgAddrInBuf;
+	lastFrameIntact = true;
+#endif
 	//the transmission has ended
 	//put the message length at the beggining of the message data in buffer
 	//increment numMsgsInBuffer
 	//increment bufWriteIndex
-	if(frameLen>0){
-		rcvdBytesBuf[msgAddrInBuf] = frameLen - 1;  //minus the 'len' byte
-		numMsgsInBuffer++;
-		//if a message's length is 0, then this block will not run and bufWriteIndex will stay
-		//the same and next msg will be written over it
-		incBufWriteIndex();
-	}
+	rcvdBytesBuf[msgAddrInBuf & TRF_RX_BUF_MASK] = frameLen - 1;  //minus the 'len' byte
+	numMsgsInBuffer++;
+	TRF_STATS_INC(frames);
+	incBufWriteIndex();
 }
 
 
+#ifdef TRF_EOT_TIMER
+
 /**
- * This function is called from the interrupt routine when 8 bits of data has been received
- * It turns the bits into a byte and puts it in the buffer
+ * Arms Timer1's compare B to fire MIN_TX_INTERVAL_REAL after the edge that happened at 'edgeTime'
+ * Called on every edge during a transmission, so it only fires once the line has been silent 
+ * for that long
 **/
-inline void process_received_byte(){
+inline void arm_EOT_timer(uint16_t edgeTime){
+	OCR1B = edgeTime + (MIN_TX_INTERVAL_REAL << TRF_TIMER1_TICK_SHIFT);
+	TIFR1 = (1 << OCF1B);		// clear a match that might have happened before re-arming
+	TIMSK1 |= (1 << OCIE1B);
+}
 
+/**
+ * Nothing has been received for MIN_TX_INTERVAL_REAL, the transmission is over
+**/
+ISR(TIMER1_COMPB_vect){
 	using namespace tinyrf;
-	byte rcvdByte = 0x00;
+	//one shot, the next edge will arm it again
+	TIMSK1 &= ~(1 << OCIE1B);
+	if(transmitOngoing){
+		EOT();
+	}
+}
 
-	for(uint8_t i=0; i<8; i++){
-		//if pulse is greater than START_PULSE_PERIOD then we will not be here
-		if( 
-			rcvdPulses[i] > (ONE_PULSE_PERIOD - ONE_PULSE_TRIGG_ERROR)
-			&& rcvdPulses[i] < (ONE_PULSE_PERIOD + ONE_PULSE_TRIGG_ERROR)
-		){
-			rcvdByte |= ( 1<<(7-i) );	//tx sends bytes in reverse
-		}
-		else if( 
-			rcvdPulses[i] < (ZERO_PULSE_PERIOD - ZERO_PULSE_TRIGG_ERROR)
-			|| rcvdPulses[i] > (ZERO_PULSE_PERIOD + ZERO_PULSE_TRIGG_ERROR)
-		){
-			//this is noise => end of transmission
-			//regardless of whether we have received 'rcvdFrameLen' byte of data we EOT here
-			EOT();
-			return;
-		}
+#endif	/* TRF_EOT_TIMER */
+
+
+/**
+ * Throws away the frame that is being received, called when its 'len' byte is invalid or the 
+ * filter rejects it
+ * The frame's bytes are freed by moving bufWriteIndex back, and the rest of its pulses are ignored
+ * because the transmission is no longer ongoing
+**/
+inline void drop_frame(){
+	using namespace tinyrf;
+	transmitOngoing = false;
+#ifdef TRF_RX_ADAPTIVE_THRESHOLDS
+	reset_thresholds();
+#endif
+	bufWriteIndex = msgAddrInBuf;
+}
+
+
+#ifdef TRF_RX_FILTER
+
+/**
+ * Called when the first data byte of a frame is in the buffer, returns false if the filter
+ * rejects the frame
+**/
+inline bool filter_frame(byte rcvdByte){
+	using namespace tinyrf;
+	if(!rxFilter){
+		return true;
 	}
+#ifdef TRF_SENDER_ADDRESSING
+	uint8_t addr = rcvdBytesBuf[(msgAddrInBuf + 1 + TRF_ERR_CHK_SIZE) & TRF_RX_BUF_MASK];
+#else
+	uint8_t addr = 0;
+#endif
+	return rxFilter(rcvdFrameLen - 1 - TRF_FRAME_OVERHEAD, addr, rcvdByte);
+}
+
+#endif	/* TRF_RX_FILTER */
+
+
+/**
+ * This function is called from the interrupt routine when 8 bits of data has been received
+ * The bits have already been classified and shifted into rcvdByte by the interrupt routine
+ * so all that's left is putting the byte in the buffer
+**/
+inline void process_received_byte(byte rcvdByte){
+
+	using namespace tinyrf;
 
 	//TRF_PRINT((char)rcvdByte);
 
@@ -173,21 +674,58 @@ inline void process_received_byte(){
 	//if this is the first byte of the frame then it's the message length
 	//this is only for detecting EOT and isn't stored in buffer
 	if(frameLen == 0){
-		#if defined(TRF_ERROR_CHECKING_NONE) && defined(TRF_SEQ_DISABLED)
-			rcvdFrameLen = rcvdByte + 1;
-		#elif defined(TRF_ERROR_CHECKING_NONE) || defined(TRF_SEQ_DISABLED)
-			rcvdFrameLen = rcvdByte + 2;
-		#else
-			rcvdFrameLen = rcvdByte + 3;
-		#endif
+		//no transmitter sends empty or longer than TRF_MAX_MSG_LEN messages, so this is noise or a
+		//corrupted 'len' byte, either way we would swallow up to 255 bytes of whatever comes next
+		if(rcvdByte == 0 || rcvdByte > TRF_MAX_MSG_LEN){
+			drop_frame();
+			TRF_STATS_INC(noise);
+			return;
+		}
+		rcvdFrameLen = rcvdByte + 1 + TRF_FRAME_OVERHEAD;
 		//TRF_PRINTLN(rcvdFrameLen);
+	#ifndef TRF_SEQ_DISABLED
+		//only a frame that was received whole can be repeated, a truncated one has a shorter length
+		sameAsLastFrame = lastFrameIntact 
+			&& (rcvdBytesBuf[lastFrameAddr & TRF_RX_BUF_MASK] == rcvdByte + TRF_FRAME_OVERHEAD);
+	#endif
 	}
 	//add it to the buffer
 	//increment bufWriteIndex
 	//increment frameLen
 	else{
-		incBufWriteIndex();
-		rcvdBytesBuf[bufWriteIndex] = rcvdByte;
+	#ifndef TRF_SEQ_DISABLED
+		//while the frame is the same as the last one we only compare it and don't store it, so a 
+		//repeat never pushes older frames out of the buffer, see EOT()
+		//once it's different it gets the bytes it has in common with the last frame and from then
+		//on it's stored like any other frame
+		if(sameAsLastFrame && rcvdByte != last_frame_byte(frameLen)){
+			sameAsLastFrame = false;
+			for(uint8_t pos=1; pos<frameLen; pos++){
+				//read before writing, in case this overwrites the last frame
+				byte lastByte = last_frame_byte(pos);
+				incBufWriteIndex();
+				rcvdBytesBuf[bufWriteIndex & TRF_RX_BUF_MASK] = lastByte;
+			}
+		}
+	#endif
+	#ifdef TRF_RX_ISR_ERR_CHK
+		update_err_chk(rcvdByte);
+	#endif
+	#ifndef TRF_SEQ_DISABLED
+		if(!sameAsLastFrame)
+	#endif
+		{
+			incBufWriteIndex();
+			rcvdBytesBuf[bufWriteIndex & TRF_RX_BUF_MASK] = rcvdByte;
+		#ifdef TRF_RX_FILTER
+			//with the first data byte everything the filter needs has been received
+			//a repeat of the last frame doesn't get here, the filter has already accepted it
+			if(frameLen == TRF_FRAME_OVERHEAD + 1 && !filter_frame(rcvdByte)){
+				drop_frame();
+				return;
+			}
+		#endif
+		}
 	}
 
 	frameLen++;
@@ -200,14 +738,220 @@ inline void process_received_byte(){
 }
 
 
+#ifdef TRF_FEC_HAMMING
+
 /**
- * Interrupt routine called on falling edges of pulses
+ * This function is called from the interrupt routine when 8 bits of data has been received
+ * Every byte of the frame is sent as two Hamming(8,4) codewords, so every other call we 
+ * have a whole byte to put in the buffer
+**/
+inline void process_received_codeword(byte codeword){
+	using namespace tinyrf;
+	byte nibble = hamming_decode(codeword);
+	if(!rcvdHighNibble){
+		rcvdNibble = nibble;
+		rcvdHighNibble = true;
+	}
+	else{
+		rcvdHighNibble = false;
+		process_received_byte( (rcvdNibble << 4) | nibble );
+	}
+}
+
+#endif
+
+
+//the received 8 bits are either a codeword or a byte
+#ifdef TRF_FEC_HAMMING
+	#define TRF_PROCESS_RCVD_BITS process_received_codeword
+#else
+	#define TRF_PROCESS_RCVD_BITS process_received_byte
+#endif
+
+
+/**
+ * Called when a START is received
+**/
+inline void start_frame(){
+	using namespace tinyrf;
+	//if we receive a start while we are already processing an ongoing transmission
+	//it means the previous transmission has ended
+	if(transmitOngoing){
+		EOT();
+	}
+	transmitOngoing = true;
+	msgAddrInBuf = bufWriteIndex;
+	TRF_STATS_INC(starts);
+	frameLen = 0;
+#ifdef TRF_FEC_HAMMING
+	rcvdHighNibble = false;
+#endif
+}
+
+
+#ifndef TRF_LINE_CODE_MANCHESTER
+
+/**
+ * Decodes one pulse period, called on falling edges of pulses
  * We use a pulse period encoding to determine what a pulse means
  * As suggested here: http://www.romanblack.com/RF/cheapRFmodules.htm
  * This way we will have both HIGH and LOW periods in both 1 and 0 bits, eliminating 
  * the need for manchester encoding and other workarounds for sending equal HIGH and LOW
  * Pulse periods are defined in the file TinyRF.h
- * This interrupt routine usually take 8us - sometimes goes up to 30us
+ * Each pulse is decoded as soon as it arrives so the cost of every edge is more or less the same
+ * The 8th edge of each byte takes a bit longer because it also puts the byte in the buffer
+**/
+inline void process_pulse(uint16_t pulsePeriod){
+
+	using namespace tinyrf;
+
+	static uint8_t pulse_count = 0;
+	//bits are shifted in here as they arrive, so we don't need to keep the pulses around
+	static byte rcvdByte = 0x00;
+
+	//TRF_PRINTLN(pulsePeriod);
+
+#ifdef TRF_RX_ADAPTIVE_THRESHOLDS
+	if(!transmitOngoing){
+		learn_preamble(pulsePeriod);
+	}
+#endif
+	
+	//start of transmission
+	if(pulsePeriod > TRF_START_MIN && pulsePeriod < TRF_START_MAX){
+		start_frame();
+		pulse_count = 0;
+	}
+	else if(transmitOngoing){
+		//we classify each pulse as soon as it arrives instead of buffering all 8 and then
+		//classifying them all at once, this way every edge costs about the same
+		//tx sends bytes MSB first so we shift left
+	#ifdef TRF_SYMBOLS_4LEVEL
+		//the symbols are close together so the decision boundaries are half way between them
+		if(pulsePeriod < SYMBOL_MIN || pulsePeriod > SYMBOL_MAX){
+			//this is noise => end of transmission
+			EOT();
+			return;
+		}
+		rcvdByte <<= 2;
+		if(pulsePeriod > (ZERO_PULSE_PERIOD + 2*SYMBOL_STEP + SYMBOL_STEP/2)){
+			rcvdByte |= 0x03;
+		}
+		else if(pulsePeriod > (ZERO_PULSE_PERIOD + SYMBOL_STEP + SYMBOL_STEP/2)){
+			rcvdByte |= 0x02;
+		}
+		else if(pulsePeriod > (ZERO_PULSE_PERIOD + SYMBOL_STEP/2)){
+			rcvdByte |= 0x01;
+		}
+		pulse_count += 2;
+	#else
+		rcvdByte <<= 1;
+		if(pulsePeriod > TRF_ONE_MIN && pulsePeriod < TRF_ONE_MAX){
+			rcvdByte |= 0x01;
+		}
+		else if(pulsePeriod < TRF_ZERO_MIN || pulsePeriod > TRF_ZERO_MAX){
+			//this is noise => end of transmission
+			//regardless of whether we have received 'rcvdFrameLen' byte of data we EOT here
+			EOT();
+			return;
+		}
+		pulse_count++;
+	#endif
+		if(pulse_count == 8){
+			TRF_PROFILE_BYTE_EDGE();
+			TRF_PROCESS_RCVD_BITS(rcvdByte);
+			pulse_count = 0;
+		}
+	}
+
+}
+
+#else	/* TRF_LINE_CODE_MANCHESTER */
+
+/**
+ * Decodes one edge of a manchester coded transmission, called on both edges
+ * A 1 is LOW then HIGH and a 0 is HIGH then LOW, so there is always an edge in the middle of a bit
+ * and the direction of that edge is the bit. There is also an edge between two equal bits.
+ * So the time between two edges is either half a bit (middle <-> boundary) or a whole bit 
+ * (middle -> middle) and we only need to keep track of whether the last edge was in the middle
+ * The START is a long HIGH followed by a 1, its falling edge is a bit boundary
+**/
+inline void process_manchester_edge(uint16_t pulsePeriod, bool rising){
+
+	using namespace tinyrf;
+
+	static uint8_t bit_count = 0;
+	static byte rcvdByte = 0x00;
+	//whether the last edge was in the middle of a bit
+	static bool atMid = false;
+	//the first bit after START is always 1 and is only there to get the edges in sync
+	static bool syncBit = false;
+
+	//start of transmission
+	if( 
+		!rising
+		&& pulsePeriod > (MANCHESTER_START_DURATION - 2*MANCHESTER_TRIGG_ERROR)
+		&& pulsePeriod < (MANCHESTER_START_DURATION + 2*MANCHESTER_TRIGG_ERROR)
+	){
+		start_frame();
+		bit_count = 0;
+		atMid = false;
+		syncBit = true;
+		return;
+	}
+
+	if(!transmitOngoing){
+		return;
+	}
+
+	if( 
+		pulsePeriod > (MANCHESTER_HALF_BIT - MANCHESTER_TRIGG_ERROR)
+		&& pulsePeriod < (MANCHESTER_HALF_BIT + MANCHESTER_TRIGG_ERROR)
+	){
+		//half a bit after the middle of a bit is a boundary, nothing to decode there
+		atMid = !atMid;
+		if(!atMid){
+			return;
+		}
+	}
+	else if( 
+		!atMid
+		|| pulsePeriod < (2*MANCHESTER_HALF_BIT - MANCHESTER_TRIGG_ERROR)
+		|| pulsePeriod > (2*MANCHESTER_HALF_BIT + MANCHESTER_TRIGG_ERROR)
+	){
+		//a whole bit can only be between the middles of two bits, anything else is noise
+		//this is noise => end of transmission
+		EOT();
+		return;
+	}
+
+	//we are in the middle of a bit
+	if(syncBit){
+		syncBit = false;
+		if(!rising){
+			EOT();
+		}
+		return;
+	}
+
+	//tx sends bytes MSB first so we shift left
+	rcvdByte = (rcvdByte << 1) | (rising ? 0x01 : 0x00);
+	bit_count++;
+	if(bit_count == 8){
+		TRF_PROFILE_BYTE_EDGE();
+		TRF_PROCESS_RCVD_BITS(rcvdByte);
+		bit_count = 0;
+	}
+
+}
+
+#endif	/* TRF_LINE_CODE_MANCHESTER */
+
+
+/**
+ * Interrupt routine called on falling edges of pulses when using an external interrupt
+ * The pulse period is measured using micros()
+ * This interrupt routine usually take 8us, enable TRF_RX_PROFILE to measure it
  * With our 100+us pulse periods this shouldn't be a problem
 **/
 #ifdef TRF_MCU_ESP
@@ -220,65 +964,166 @@ inline void process_received_byte(){
 
 	interruptRun = true;
 
-	static uint8_t pulse_count = 0;
 	static unsigned long lastTime = 0;
 
+#ifdef TRF_EOT_TIMER
+	uint16_t edgeTime = TCNT1;
+#endif
+
 	unsigned long time = micros();
 	unsigned long pulsePeriod = time - lastTime;
 	lastTime = time;
 
+#ifdef TRF_RX_PROFILE
+	//we already have the time the interrupt started, no need to read the clock again
+	#ifdef TRF_EOT_TIMER
+		uint16_t profStart = edgeTime;
+	#else
+		uint16_t profStart = time;
+	#endif
+#endif
+
 	if(interruptDisabled){
 		return;
 	}
 
-	//TRF_PRINTLN(pulsePeriod);
-	
-	//start of transmission
-	if( 
-		pulsePeriod > (START_PULSE_PERIOD - START_PULSE_TRIGG_ERROR)
-		&& pulsePeriod < (START_PULSE_PERIOD + START_PULSE_MAX_ERROR)
-	){
-		//if we receive a start while we are already processing an ongoing transmission
-		//it means the previous transmission has ended
-		if(transmitOngoing){
-			EOT();
-		}
-		transmitOngoing = true;
-		pulse_count = 0;
-		msgAddrInBuf = bufWriteIndex;
-		frameLen = 0;
+	TRF_STATS_INC(edges);
+
+	//all of our pulse periods fit in 16 bits, anything longer is just a very long pulse
+	//this way process_pulse() can do 16-bit comparisons which are much cheaper on AVR
+	if(pulsePeriod > 0xFFFF){
+		pulsePeriod = 0xFFFF;
 	}
-	else if(transmitOngoing){
-		rcvdPulses[pulse_count] = pulsePeriod;
-		pulse_count++;
-		if(pulse_count == 8){
-			process_received_byte();
-			pulse_count = 0;
-		}
+
+#ifdef TRF_RX_HISTOGRAM
+	hist_add(pulsePeriod);
+#endif
+
+#ifdef TRF_LINE_CODE_MANCHESTER
+	process_manchester_edge(pulsePeriod, TRF_RX_READ());
+#else
+	process_pulse(pulsePeriod);
+#endif
+
+#ifdef TRF_EOT_TIMER
+	if(transmitOngoing){
+		arm_EOT_timer(edgeTime);
 	}
+#endif
+
+#ifdef TRF_RX_PROFILE
+	profile_edge(profStart);
+#endif
 
 	//TRF_PRINTLN(micros() - time);
 
 }
 
+
+#ifdef TRF_RX_INPUT_CAPTURE
+
+namespace tinyrf{
+	//number of Timer1 overflows since the last captured edge, saturates at 2
+	volatile uint8_t icpOverflows = 0;
+}
+
+ISR(TIMER1_OVF_vect){
+	using namespace tinyrf;
+	if(icpOverflows < 2){
+		icpOverflows++;
+	}
+}
+
+/**
+ * Interrupt routine called on falling edges of pulses when using the input capture unit
+ * The timer value is latched by hardware the moment the edge arrives, so unlike micros() the 
+ * pulse period doesn't depend on how long it took for the interrupt to run
+**/
+ISR(TIMER1_CAPT_vect){
+
+	using namespace tinyrf;
+
+	interruptRun = true;
+
+	static uint16_t lastCapture = 0;
+
+	uint16_t capture = ICR1;
+	uint16_t ticks = capture - lastCapture;
+
+#ifdef TRF_LINE_CODE_MANCHESTER
+	//we need both edges, so after each capture we switch to the other one
+	//the flag has to be cleared after changing the edge
+	bool rising = TCCR1B & (1 << ICES1);
+	TCCR1B ^= (1 << ICES1);
+	TIFR1 = (1 << ICF1);
+#endif
+
+	//if an overflow is pending and the captured value is small the overflow happened before 
+	//this edge, count it here and clear the flag so TIMER1_OVF_vect doesn't count it again
+	uint8_t overflows = icpOverflows;
+	if( (TIFR1 & (1 << TOV1)) && capture < 0x8000 ){
+		overflows++;
+		TIFR1 = (1 << TOV1);
+	}
+	icpOverflows = 0;
+
+	//the pulse was longer than what fits in 16 bits of timer ticks
+	if( overflows > 1 || (overflows == 1 && capture >= lastCapture) ){
+		ticks = 0xFFFF;
+	}
+
+	lastCapture = capture;
+
+	if(interruptDisabled){
+		return;
+	}
+
+	TRF_STATS_INC(edges);
+
+#ifdef TRF_RX_HISTOGRAM
+	hist_add(ticks >> TRF_TIMER1_TICK_SHIFT);
+#endif
+
+#ifdef TRF_LINE_CODE_MANCHESTER
+	process_manchester_edge(ticks >> TRF_TIMER1_TICK_SHIFT, rising);
+#else
+	process_pulse(ticks >> TRF_TIMER1_TICK_SHIFT);
+#endif
+
+#ifdef TRF_EOT_TIMER
+	if(transmitOngoing){
+		arm_EOT_timer(capture);
+	}
+#endif
+
+#ifdef TRF_RX_PROFILE
+	//counted from the edge, so the time it took for the interrupt to start is included
+	profile_edge(capture);
+#endif
+
+}
+
+#endif	/* TRF_RX_INPUT_CAPTURE */
+
 //degug stuff
 //#define showbuffer
 //#define showseq
 //#define showduplicates
 
-uint8_t getReceivedData(byte buf[], uint8_t bufSize, uint8_t &numRcvdBytes, uint8_t &numLostMsgs){
+/**
+ * Detects end of transmission when no data has come in for a while
+ * Called by the functions that read the buffer
+**/
+inline void check_EOT(){
 
 	using namespace tinyrf;
 
-	numRcvdBytes = 0;
-	numLostMsgs = 0;
-
 	//we rely on noise to detect end of transmission
 	//in the rare event that there was no noise(the interrupt did not trigger) for a long time
 	//consider the transmission over and add received data to buffer
-#if !defined(TRF_EOT_IN_TX) && !defined(TRF_EOT_NONE)
+#if !defined(TRF_EOT_IN_TX) && !defined(TRF_EOT_NONE) && !defined(TRF_EOT_TIMER)
 
-	//todo: there is no guarantee this will be called frequently enough so put it in a timer
+	//there is no guarantee this will be called frequently enough, if that's a problem use TRF_EOT_TIMER
 
 	//we can't use lastTime which is set in the interrupt because it is a long (non-atomic)
 	//and using it here will wreak havoc, so we calculate another one here
@@ -306,67 +1151,202 @@ uint8_t getReceivedData(byte buf[], uint8_t bufSize, uint8_t &numRcvdBytes, uint
 			interruptDisabled = false;
 		}
 	}
-
+
+#endif
+
+}
+
+
+#ifndef TRF_SEQ_DISABLED
+
+/**
+ * Checks a message's sequence number against the last one we received from the same transmitter
+ * Number of messages that were lost before this message will be put in numLostMsgs
+ * Returns TRF_ERR_DUPLICATE_MSG if this is a repeat of the last message, TRF_ERR_SUCCESS otherwise
+**/
+uint8_t check_seq(uint8_t addr, uint8_t seq, uint8_t &numLostMsgs){
+
+	using namespace tinyrf;
+
+#ifdef TRF_SENDER_ADDRESSING
+	uint8_t i = 0;
+	while(i < numSenders && senderAddrs[i] != addr){
+		i++;
+	}
+	//if this is the first seq we receive from this transmitter
+	if(i == numSenders){
+		if(numSenders < TRF_RX_MAX_SENDERS){
+			numSenders++;
+		}
+		else{
+			//the table is full, forget the transmitter that was added first
+			i = oldestSender;
+			if(++oldestSender == TRF_RX_MAX_SENDERS){
+				oldestSender = 0;
+			}
+		}
+		senderAddrs[i] = addr;
+		senderSeqs[i] = seq;
+		return TRF_ERR_SUCCESS;
+	}
+	uint8_t &lastSeq = senderSeqs[i];
+#else
+	(void)addr;
+	//if this is the first seq we receive
+	if(lastSeq == -1){
+		lastSeq = seq;
+		return TRF_ERR_SUCCESS;
+	}
 #endif
 
-	if(numMsgsInBuffer == 0){
-		return TRF_ERR_NO_DATA;
+	//the last TRF_RX_DUP_WINDOW seq#s (the last one and the ones before it) are repeats
+	if((uint8_t)(lastSeq - seq) < TRF_RX_DUP_WINDOW){
+		//we can only rely on seq# for detecting duplicates if we have error checking
+		#ifndef TRF_ERROR_CHECKING_NONE
+			TRF_STATS_INC_MAIN(duplicates);
+			return TRF_ERR_DUPLICATE_MSG;
+		#else
+			return TRF_ERR_SUCCESS;
+		#endif
+	}
+	else if( seq > (uint8_t)(lastSeq + 1) ){
+		numLostMsgs = seq - lastSeq - 1;
+	}
+	else if(seq < lastSeq){
+		//seq is smaller than lastseq meaning seq was reset during lost messages
+		numLostMsgs = 255 - lastSeq + seq;
 	}
 
-	#ifdef showbuffer
-	TRF_PRINT("len addr: ");TRF_PRINT2(bufReadIndex, DEC);
-	TRF_PRINT(" - #msgs in buf: ");TRF_PRINT(numMsgsInBuffer);
-	TRF_PRINTLN("");
-	#endif
+	lastSeq = seq;
 
-	/* manage buffer */
-	//if buffer is being overwritten wait until it's done so we get the currect bufReadIndex
-	//the time it takes the next few instructions to run is way less than the time it takes for a byte
-	//to arrive, so we're pretty sure buffer overwrite will not happen during the next few instructions
-	while(bufOverwriteOngoing){};
+	return TRF_ERR_SUCCESS;
+
+}
+
+#endif	/* TRF_SEQ_DISABLED */
+
+
+/**
+ * Takes the oldest frame out of the buffer
+ * The frame's length (without the 'len' byte) will be put in frameLen and the index of its next 
+ * byte in frameReadIndex
+ * If the frame is longer than maxFrameLen it is left in the buffer
+ * Returns TRF_ERR_SUCCESS, TRF_ERR_NO_DATA or TRF_ERR_BUFFER_OVERFLOW
+**/
+uint8_t claim_frame(uint8_t &frameReadIndex, uint8_t &frameLen, uint8_t maxFrameLen){
+
+	using namespace tinyrf;
 
+	/* manage buffer */
 	//this is how our buffer looks like:
 	//[frm0 len|frm0 crc|frm0 seq#|frm0 byte0|frm0 byte1|...|frm1 len|frm1 crc|frm1 seq#|frm1 byte0|frm1 byte1|...]
 	//frame length = data length + seq# + error checking byte
 
+	//the interrupt also moves bufReadIndex when it overwrites the oldest frame, so we take the 
+	//frame with interrupts off. this is only a few instructions so unlike waiting for an ongoing 
+	//overwrite to finish it has a fixed cost
+	noInterrupts();
+
+	if(numMsgsInBuffer == 0){
+		interrupts();
+		return TRF_ERR_NO_DATA;
+	}
+
 	//bufReadIndex points to the first byte of frame, i.e. the length
-	uint8_t frameLen = rcvdBytesBuf[bufReadIndex];
-	lim_inc(bufReadIndex);
-	lim_dec(bufsDiff);
+	frameReadIndex = bufReadIndex;
+	frameLen = rcvdBytesBuf[frameReadIndex & TRF_RX_BUF_MASK];
+
+	//leave it in the buffer if the caller doesn't have room for it
+	if(frameLen > maxFrameLen){
+		interrupts();
+		return TRF_ERR_BUFFER_OVERFLOW;
+	}
 
-	uint8_t frameReadIndex = bufReadIndex;
+	frameReadIndex++;
 	//move bufReadIndex 'length' bytes forward to point to the next frame
-	lim_sum(bufReadIndex, frameLen);
-	lim_sub(bufsDiff, frameLen);
+	bufReadIndex = frameReadIndex + frameLen;
 
 	//we consider this message processed as of now
 	numMsgsInBuffer--;
 
+	interrupts();
+
+	#ifdef showbuffer
+	TRF_PRINT("len addr: ");TRF_PRINT2((uint8_t)(frameReadIndex - 1), DEC);
+	TRF_PRINT(" - #msgs in buf: ");TRF_PRINT(numMsgsInBuffer);
+	TRF_PRINTLN("");
+	#endif
+
+	return TRF_ERR_SUCCESS;
+
+}
+
+
+#ifndef TRF_ERROR_CHECKING_NONE
+/**
+ * Reads the error checking byte(s) of a frame and moves 'frameReadIndex' past them
+ * With TRF_RX_ISR_ERR_CHK the first one is the result of the check done by the interrupt
+**/
+inline TRF_ERR_CHK_TYPE read_err_chk(uint8_t &frameReadIndex){
+	using namespace tinyrf;
+	TRF_ERR_CHK_TYPE errChck = rcvdBytesBuf[frameReadIndex & TRF_RX_BUF_MASK];
+	frameReadIndex++;
+#ifdef TRF_ERROR_CHECKING_CRC16
+	#ifndef TRF_RX_ISR_ERR_CHK
+	errChck = (errChck << 8) | rcvdBytesBuf[frameReadIndex & TRF_RX_BUF_MASK];
+	#endif
+	frameReadIndex++;
+#endif
+	return errChck;
+}
+#endif
+
+
+/**
+ * Copies the data of a frame taken with claim_frame() into buf and checks it for errors
+ * Number of data bytes will be put in numRcvdBytes, the frame's sequence number in seq and the 
+ * sender's address in addr
+ * Returns TRF_ERR_SUCCESS if the frame is valid, otherwise one of the other error codes
+**/
+uint8_t read_frame(uint8_t frameReadIndex, uint8_t frameLen, byte buf[], uint8_t bufSize, 
+	uint8_t &numRcvdBytes, uint8_t &seq, uint8_t &addr){
+
+	using namespace tinyrf;
+
+	numRcvdBytes = 0;
+	seq = 0;
+	addr = 0;
+
 	//a buffer overwrite could happen from this point forward, writing to the buffer as we are 
 	//reading it. but it will only corrupt this one frame, unless we are sending very fast and
 	//reading very slowly, in which case the buffer keeps being overwritten without us being able
 	//to catch up with it
 
-	//a frame's minimum length is 3 bytes: CRC + SEQ + 1 Byte Data (at least)
+	//a frame's minimum length is CRC + SEQ + 1 Byte Data (at least), see TRF_MIN_FRAME_LEN
 	if(frameLen == 0){
 		return TRF_ERR_NO_DATA;
 	}
-	else if(frameLen < 3){
+	else if(frameLen < TRF_MIN_FRAME_LEN){
 		return TRF_ERR_NOISE;
 	}
 
 	uint8_t dataLen = frameLen;
 
 	#ifndef TRF_ERROR_CHECKING_NONE
+		dataLen -= TRF_ERR_CHK_SIZE;
+		TRF_ERR_CHK_TYPE errChckRcvd = read_err_chk(frameReadIndex);
+	#endif
+
+	#ifdef TRF_SENDER_ADDRESSING
 		dataLen--;
-		byte errChckRcvd = rcvdBytesBuf[frameReadIndex];
-		lim_inc(frameReadIndex);
+		addr = rcvdBytesBuf[frameReadIndex & TRF_RX_BUF_MASK];
+		frameReadIndex++;
 	#endif
 
 	#ifndef TRF_SEQ_DISABLED
 		dataLen--;
-		uint8_t seq = rcvdBytesBuf[frameReadIndex];
-		lim_inc(frameReadIndex);
+		seq = rcvdBytesBuf[frameReadIndex & TRF_RX_BUF_MASK];
+		frameReadIndex++;
 	#endif
 
 	numRcvdBytes = dataLen;
@@ -380,7 +1360,7 @@ uint8_t getReceivedData(byte buf[], uint8_t bufSize, uint8_t &numRcvdBytes, uint
 	TRF_PRINT(" - read index: ");TRF_PRINT2(frameReadIndex, DEC);
 	TRF_PRINT(" - len: ");TRF_PRINT(frameLen);
 	TRF_PRINTLN("");
-	for(int i=0; i<256; i++){
+	for(int i=0; i<TRF_RX_BUFFER_SIZE; i++){
 		TRF_PRINT(i);TRF_PRINT("[");TRF_PRINT(rcvdBytesBuf[i]);TRF_PRINT("],");
 	}
 	TRF_PRINTLN("");
@@ -388,18 +1368,28 @@ uint8_t getReceivedData(byte buf[], uint8_t bufSize, uint8_t &numRcvdBytes, uint
 
 	//copy the data from 'frameReadIndex' until frameReadIndex+dataLen
 	for(uint8_t i=0; i<dataLen; i++){
-		buf[dataLen-1-i] = rcvdBytesBuf[frameReadIndex];	//tx sends data in reverse
-		lim_inc(frameReadIndex);
+		#ifdef TRF_DATA_NATURAL_ORDER
+		buf[i] = rcvdBytesBuf[frameReadIndex & TRF_RX_BUF_MASK];
+		#else
+		buf[dataLen-1-i] = rcvdBytesBuf[frameReadIndex & TRF_RX_BUF_MASK];	//tx sends data in reverse
+		#endif
+		frameReadIndex++;
 	}
 
 	/*** error checking ***/
-	#ifndef TRF_ERROR_CHECKING_NONE
+	#if defined(TRF_RX_ISR_ERR_CHK)
+		//the interrupt has already checked it and put the result in place of the error checking byte
+		if(errChckRcvd != TRF_ERR_SUCCESS){
+			return errChckRcvd;
+		}
+	#elif !defined(TRF_ERROR_CHECKING_NONE)
 		#ifndef TRF_SEQ_DISABLED
-			byte errChckCalc = TRF_ERR_CHK_FUNC(buf, dataLen, seq);
+			TRF_ERR_CHK_TYPE errChckCalc = TRF_ERR_CHK_FUNC(buf, dataLen, TRF_ERR_CHK_SEED(addr, seq));
 		#else
-			byte errChckCalc = TRF_ERR_CHK_FUNC(buf, dataLen);
+			TRF_ERR_CHK_TYPE errChckCalc = TRF_ERR_CHK_FUNC(buf, dataLen);
 		#endif
 		if(errChckRcvd != errChckCalc){
+			TRF_STATS_INC_MAIN(corrupted);
 			return TRF_ERR_CORRUPTED;
 		}
 		//if all data is zeroes CRC will also be zero and CRC check will pass
@@ -413,11 +1403,40 @@ uint8_t getReceivedData(byte buf[], uint8_t bufSize, uint8_t &numRcvdBytes, uint
 				}
 			}
 			if(allZeroes){
+				TRF_STATS_INC_MAIN(noise);
 				return TRF_ERR_NOISE;
 			}
 		}
 	#endif
 
+	return TRF_ERR_SUCCESS;
+
+}
+
+
+/**
+ * getReceivedData() with all the outputs, the public versions call this
+**/
+uint8_t get_received_data(byte buf[], uint8_t bufSize, uint8_t &numRcvdBytes, uint8_t &numLostMsgs, 
+	uint8_t &senderAddr){
+
+	numRcvdBytes = 0;
+	numLostMsgs = 0;
+
+	check_EOT();
+
+	uint8_t frameReadIndex;
+	uint8_t frameLen;
+	if(claim_frame(frameReadIndex, frameLen, 0xFF) == TRF_ERR_NO_DATA){
+		return TRF_ERR_NO_DATA;
+	}
+
+	uint8_t seq;
+	uint8_t err = read_frame(frameReadIndex, frameLen, buf, bufSize, numRcvdBytes, seq, senderAddr);
+	if(err != TRF_ERR_SUCCESS){
+		return err;
+	}
+
 	/*** sequence number ***/
 	#ifndef TRF_SEQ_DISABLED
 
@@ -425,67 +1444,493 @@ uint8_t getReceivedData(byte buf[], uint8_t bufSize, uint8_t &numRcvdBytes, uint
 		TRF_PRINT(seq);TRF_PRINT(":");
 		#endif
 
-		static int lastSeq = -1;
 		static boolean returnOnDuplicate = false;
 
-		//if this is the first seq we receive
-		if(lastSeq == -1){
-			lastSeq = seq;
-			return TRF_ERR_SUCCESS;
-		}
-		else if(seq == lastSeq){
-			//we can only rely on seq# for detecting duplicates if we have error checking
-			#ifndef TRF_ERROR_CHECKING_NONE
+		if(check_seq(senderAddr, seq, numLostMsgs) == TRF_ERR_DUPLICATE_MSG){
 
-				#ifdef showduplicates
-				TRF_PRINTLN("received duplicate message");
-				#endif
+			#ifdef showduplicates
+			TRF_PRINTLN("received duplicate message");
+			#endif
 
-				if(returnOnDuplicate){
-					return TRF_ERR_DUPLICATE_MSG;
-				}
+			if(returnOnDuplicate){
+				return TRF_ERR_DUPLICATE_MSG;
+			}
 
-				//we set this flag to prevent a recursion to occur
-				//recursion would be ok but it uses RAM which an MCU doesn't have so we do this instead
-				returnOnDuplicate = true;
+			//we set this flag to prevent a recursion to occur
+			//recursion would be ok but it uses RAM which an MCU doesn't have so we do this instead
+			returnOnDuplicate = true;
 
-				//read the duplicates until we reach a non-duplicate
-				while(1){
-					uint8_t err = getReceivedData(buf, bufSize, numRcvdBytes, numLostMsgs);
-					if(err == TRF_ERR_DUPLICATE_MSG){
-						continue;
-					}
-					else{
-						//we have reached a non-duplicate message
-						//set returnOnDuplicate to false again and return the return code
-						returnOnDuplicate = false;
-						return err;
-					}
+			//read the duplicates until we reach a non-duplicate
+			while(1){
+				uint8_t err = get_received_data(buf, bufSize, numRcvdBytes, numLostMsgs, senderAddr);
+				if(err == TRF_ERR_DUPLICATE_MSG){
+					continue;
+				}
+				else{
+					//we have reached a non-duplicate message
+					//set returnOnDuplicate to false again and return the return code
+					returnOnDuplicate = false;
+					return err;
 				}
+			}
 
-			#else	//TRF_ERROR_CHECKING_NONE
-				return TRF_ERR_SUCCESS;
-			#endif
-		}
-		else if( seq > (uint8_t)(lastSeq + 1) ){
-			numLostMsgs = seq - lastSeq - 1;
-		}
-		else if(seq < lastSeq){
-			//seq is smaller than lastseq meaning seq was reset during lost messages
-			numLostMsgs = 255 - lastSeq + seq;
 		}
 
-		lastSeq = seq;
-
 	#endif
 
 	return TRF_ERR_SUCCESS;
 
 }
 
+uint8_t getReceivedData(byte buf[], uint8_t bufSize, uint8_t &numRcvdBytes, uint8_t &numLostMsgs){
+	uint8_t a;
+#ifdef TRF_RX_PROFILE
+	uint16_t profStart = TRF_PROFILE_CLOCK();
+	uint8_t err = get_received_data(buf, bufSize, numRcvdBytes, numLostMsgs, a);
+	profile_read(profStart);
+	return err;
+#else
+	return get_received_data(buf, bufSize, numRcvdBytes, numLostMsgs, a);
+#endif
+}
+
 uint8_t getReceivedData(byte buf[],  uint8_t bufSize, uint8_t &numRcvdBytes){
 	uint8_t l = 0;
 	return getReceivedData(buf, bufSize, numRcvdBytes, l);
 }
 
+#ifdef TRF_SENDER_ADDRESSING
+uint8_t getReceivedData(byte buf[], uint8_t bufSize, uint8_t &numRcvdBytes, uint8_t &numLostMsgs, 
+	uint8_t &senderAddr){
+#ifdef TRF_RX_PROFILE
+	uint16_t profStart = TRF_PROFILE_CLOCK();
+	uint8_t err = get_received_data(buf, bufSize, numRcvdBytes, numLostMsgs, senderAddr);
+	profile_read(profStart);
+	return err;
+#else
+	return get_received_data(buf, bufSize, numRcvdBytes, numLostMsgs, senderAddr);
+#endif
+}
+#endif
+
+#ifdef TRF_RX_STATS
+void getRxStats(TRFRxStats &stats){
+	//the interrupt shouldn't change the counters while we copy them
+	noInterrupts();
+	stats = tinyrf::rxStats;
+	interrupts();
+}
+
+void resetRxStats(){
+	noInterrupts();
+	memset(&tinyrf::rxStats, 0, sizeof(TRFRxStats));
+	interrupts();
+}
+#endif
+
+#ifdef TRF_RX_PROFILE
+
+//turns the running measurement into min/avg/max
+void get_timing(TRFTiming &timing, const tinyrf::TRFTimeSum &prof){
+	if(prof.count == 0){
+		timing.min = timing.avg = timing.max = 0;
+		return;
+	}
+	timing.min = prof.min;
+	timing.avg = prof.sum / prof.count;
+	timing.max = prof.max;
+}
+
+void reset_timing(tinyrf::TRFTimeSum &prof){
+	prof.min = 0xFFFF;
+	prof.max = 0;
+	prof.sum = 0;
+	prof.count = 0;
+}
+
+void getRxProfile(TRFRxProfile &profile){
+	using namespace tinyrf;
+	//the interrupt shouldn't change the measurements while we copy them
+	//the division is done afterwards so interrupts aren't off for long
+	noInterrupts();
+	TRFTimeSum edgeCopy = edgeProf;
+	TRFTimeSum byteEdgeCopy = byteEdgeProf;
+	interrupts();
+	get_timing(profile.edge, edgeCopy);
+	get_timing(profile.byteEdge, byteEdgeCopy);
+	get_timing(profile.read, readProf);
+}
+
+void resetRxProfile(){
+	using namespace tinyrf;
+	noInterrupts();
+	reset_timing(edgeProf);
+	reset_timing(byteEdgeProf);
+	interrupts();
+	reset_timing(readProf);
+}
+
+#endif	/* TRF_RX_PROFILE */
+
+#ifdef TRF_RX_HISTOGRAM
+
+/**
+ * Returns the name of the window the pulse period falls in, using the same boundaries as the 
+ * decoder, or "noise" if it isn't in any of them
+ * With TRF_RX_ADAPTIVE_THRESHOLDS these are the windows the decoder starts each frame with, the 
+ * ones it scales for a frame are only known during that frame
+**/
+const char* hist_window(uint16_t period){
+#if defined(TRF_LINE_CODE_MANCHESTER)
+	if(period > (MANCHESTER_START_DURATION - 2*MANCHESTER_TRIGG_ERROR) 
+		&& period < (MANCHESTER_START_DURATION + 2*MANCHESTER_TRIGG_ERROR)){
+		return "START";
+	}
+	if(period > (MANCHESTER_HALF_BIT - MANCHESTER_TRIGG_ERROR) 
+		&& period < (MANCHESTER_HALF_BIT + MANCHESTER_TRIGG_ERROR)){
+		return "HALF";
+	}
+	if(period > (2*MANCHESTER_HALF_BIT - MANCHESTER_TRIGG_ERROR) 
+		&& period < (2*MANCHESTER_HALF_BIT + MANCHESTER_TRIGG_ERROR)){
+		return "BIT";
+	}
+#else
+	if(period > (START_PULSE_PERIOD - START_PULSE_TRIGG_ERROR) && period < (START_PULSE_PERIOD + START_PULSE_MAX_ERROR)){
+		return "START";
+	}
+	#ifdef TRF_SYMBOLS_4LEVEL
+	if(period >= SYMBOL_MIN && period <= SYMBOL_MAX){
+		if(period > (ZERO_PULSE_PERIOD + 2*SYMBOL_STEP + SYMBOL_STEP/2)){
+			return "SYM3";
+		}
+		else if(period > (ZERO_PULSE_PERIOD + SYMBOL_STEP + SYMBOL_STEP/2)){
+			return "SYM2";
+		}
+		else if(period > (ZERO_PULSE_PERIOD + SYMBOL_STEP/2)){
+			return "SYM1";
+		}
+		return "SYM0";
+	}
+	#else
+	if(period > (ONE_PULSE_PERIOD - ONE_PULSE_TRIGG_ERROR) && period < (ONE_PULSE_PERIOD + ONE_PULSE_TRIGG_ERROR)){
+		return "ONE";
+	}
+	if(period >= (ZERO_PULSE_PERIOD - ZERO_PULSE_TRIGG_ERROR) && period <= (ZERO_PULSE_PERIOD + ZERO_PULSE_TRIGG_ERROR)){
+		return "ZERO";
+	}
+	#endif
+#endif
+	return "noise";
+}
+
+void printRxHistogram(){
+	using namespace tinyrf;
+	Serial.print(F("bin width (us): "));
+	Serial.println(1 << RX_HIST_BIN_SHIFT);
+	for(uint8_t i=0; i<TRF_RX_HIST_BINS; i++){
+		//the interrupt might be changing the count, it's two bytes
+		noInterrupts();
+		uint16_t count = rxHistogram[i];
+		interrupts();
+		if(count == 0){
+			continue;
+		}
+		uint16_t from = (uint16_t)i << RX_HIST_BIN_SHIFT;
+		Serial.print(from);
+		//the last bin has everything that's longer
+		if(i == TRF_RX_HIST_BINS - 1){
+			Serial.print(F("+ us: "));
+			Serial.println(count);
+			continue;
+		}
+		uint16_t to = from + (1 << RX_HIST_BIN_SHIFT) - 1;
+		Serial.print('-');
+		Serial.print(to);
+		Serial.print(F(" us: "));
+		Serial.print(count);
+		Serial.print(' ');
+		//if a window starts or ends inside the bin we show both sides
+		const char* fromWindow = hist_window(from);
+		const char* toWindow = hist_window(to);
+		Serial.print(fromWindow);
+		if(fromWindow != toWindow){
+			Serial.print('/');
+			Serial.print(toWindow);
+		}
+		Serial.println();
+	}
+}
+
+void resetRxHistogram(){
+	noInterrupts();
+	memset(tinyrf::rxHistogram, 0, sizeof(tinyrf::rxHistogram));
+	interrupts();
+}
+
+#endif	/* TRF_RX_HISTOGRAM */
+
+#ifdef TRF_RX_FILTER
+void setReceiveFilter(bool (*filter)(uint8_t len, uint8_t senderAddr, byte firstByte)){
+	//a pointer is two bytes, the interrupt shouldn't see half of it
+	noInterrupts();
+	tinyrf::rxFilter = filter;
+	interrupts();
+}
+#endif
+
+uint8_t drainReceivedData(byte buf[], uint8_t bufSize, TRFMsgInfo msgs[], uint8_t maxMsgs){
+
+	using namespace tinyrf;
+
+	uint8_t numMsgs = 0;
+	uint8_t offset = 0;
+
+	//we only check for EOT once for all the messages
+	check_EOT();
+
+	while(numMsgs < maxMsgs){
+
+		//frames that don't fit in what's left of buf are left in the buffer for the next call
+		//but if buf is still empty the frame won't fit next time either, so we take it out and 
+		//report it as TRF_ERR_BUFFER_OVERFLOW, otherwise it would block all the frames after it
+		uint8_t room = bufSize - offset;
+		uint8_t maxFrameLen = (room > 0xFF - TRF_FRAME_OVERHEAD || offset == 0) ? 0xFF : room + TRF_FRAME_OVERHEAD;
+
+		uint8_t frameReadIndex;
+		uint8_t frameLen;
+		if(claim_frame(frameReadIndex, frameLen, maxFrameLen) != TRF_ERR_SUCCESS){
+			break;
+		}
+
+		TRFMsgInfo &msg = msgs[numMsgs];
+		msg.offset = offset;
+		msg.len = 0;
+		msg.numLostMsgs = 0;
+
+		uint8_t seq;
+		uint8_t addr;
+		msg.err = read_frame(frameReadIndex, frameLen, &buf[offset], room, msg.len, seq, addr);
+		#ifdef TRF_SENDER_ADDRESSING
+			msg.senderAddr = addr;
+		#endif
+
+		if(msg.err == TRF_ERR_SUCCESS){
+			#ifndef TRF_SEQ_DISABLED
+				//duplicates are simply skipped, their data will be overwritten by the next message
+				if(check_seq(addr, seq, msg.numLostMsgs) == TRF_ERR_DUPLICATE_MSG){
+					continue;
+				}
+			#endif
+			offset += msg.len;
+			numMsgs++;
+		}
+		//corrupted messages and the ones that don't fit are reported but their data isn't kept
+		else if(msg.err == TRF_ERR_CORRUPTED || msg.err == TRF_ERR_BUFFER_OVERFLOW){
+			msg.len = 0;
+			numMsgs++;
+		}
+		//noise is simply skipped
+
+	}
+
+	return numMsgs;
+
+}
+
+#ifdef TRF_DATA_NATURAL_ORDER
+
+/**
+ * Removes the frame that starts at 'frameAddr' from the buffer
+ * Returns false if the interrupt has already overwritten it
+**/
+bool consume_frame(uint8_t frameAddr){
+	using namespace tinyrf;
+	bool intact = false;
+	noInterrupts();
+	//if bufReadIndex has moved on the frame was overwritten by newer data
+	if(bufReadIndex == frameAddr && numMsgsInBuffer > 0){
+		bufReadIndex = frameAddr + rcvdBytesBuf[frameAddr & TRF_RX_BUF_MASK] + 1;
+		numMsgsInBuffer--;
+		intact = true;
+	}
+	interrupts();
+	return intact;
+}
+
+#if !defined(TRF_ERROR_CHECKING_NONE) && !defined(TRF_RX_ISR_ERR_CHK)
+/**
+ * Runs the error checking function over a frame's data which might be split in two
+**/
+inline TRF_ERR_CHK_TYPE frame_err_chk(TRFFrame &frame, TRF_ERR_CHK_TYPE seq){
+	#if defined(TRF_ERROR_CHECKING_CRC) || defined(TRF_ERROR_CHECKING_CRC16)
+		//crc8() takes the running crc as its seed so we can just feed the second part after the first
+		return TRF_ERR_CHK_FUNC((byte*)frame.data2, frame.len2, TRF_ERR_CHK_FUNC((byte*)frame.data1, frame.len1, seq));
+	#elif defined(TRF_ERROR_CHECKING_CHECKSUM)
+		//checksum8() can't be chained like that, so we do the same thing it does over both parts
+		uint16_t sum = 0;
+		sum += (~seq & 0xFF);
+		for(uint8_t i=0; i<frame.len1; i++){
+			sum += (~frame.data1[i] & 0xFF);
+		}
+		for(uint8_t i=0; i<frame.len2; i++){
+			sum += (~frame.data2[i] & 0xFF);
+		}
+		sum = (sum & 0xFF) + (sum >> 8);
+		return (byte) ~sum;
+	#endif
+}
+#endif
+
+uint8_t peekReceivedData(TRFFrame &frame, uint8_t &numLostMsgs){
+
+	using namespace tinyrf;
+
+	numLostMsgs = 0;
+	frame.len1 = 0;
+	frame.len2 = 0;
+
+	check_EOT();
+
+	//we only loop to skip duplicate messages
+	while(1){
+
+		//a frame can't be overwritten unless the interrupt writes a byte so reading these two 
+		//with interrupts off is enough, the data itself stays in the buffer
+		noInterrupts();
+		if(numMsgsInBuffer == 0){
+			interrupts();
+			return TRF_ERR_NO_DATA;
+		}
+		uint8_t frameAddr = bufReadIndex;
+		uint8_t frameLen = rcvdBytesBuf[frameAddr & TRF_RX_BUF_MASK];
+		//if this frame was returned before and not consumed we return it again without checking 
+		//its seq#, otherwise it would look like a duplicate of itself
+		//this is done with interrupts off too because the interrupt clears peekPending if it 
+		//overwrites the peeked frame
+		bool peekedBefore = (peekPending && peekedFrameAddr == frameAddr);
+		peekedFrameAddr = frameAddr;
+		peekPending = true;
+		interrupts();
+
+		//a frame's minimum length is CRC + SEQ + 1 Byte Data (at least), see TRF_MIN_FRAME_LEN
+		if(frameLen == 0){
+			consumeReceivedData();
+			return TRF_ERR_NO_DATA;
+		}
+		else if(frameLen < TRF_MIN_FRAME_LEN){
+			consumeReceivedData();
+			return TRF_ERR_NOISE;
+		}
+
+		uint8_t dataLen = frameLen;
+		uint8_t frameReadIndex = frameAddr + 1;
+
+		#ifndef TRF_ERROR_CHECKING_NONE
+			dataLen -= TRF_ERR_CHK_SIZE;
+			TRF_ERR_CHK_TYPE errChckRcvd = read_err_chk(frameReadIndex);
+		#endif
+
+		#ifdef TRF_SENDER_ADDRESSING
+			dataLen--;
+			uint8_t addr = rcvdBytesBuf[frameReadIndex & TRF_RX_BUF_MASK];
+			frame.senderAddr = addr;
+			frameReadIndex++;
+		#elif !defined(TRF_SEQ_DISABLED)
+			const uint8_t addr = 0;
+		#endif
+
+		#ifndef TRF_SEQ_DISABLED
+			dataLen--;
+			uint8_t seq = rcvdBytesBuf[frameReadIndex & TRF_RX_BUF_MASK];
+			frameReadIndex++;
+		#elif !defined(TRF_ERROR_CHECKING_NONE) && !defined(TRF_RX_ISR_ERR_CHK)
+			//the error checking function uses 0 when seq# is disabled
+			uint8_t seq = 0;
+		#endif
+
+		//the data runs until the end of the buffer, the rest of it is at the beginning
+		uint8_t dataAddr = frameReadIndex & TRF_RX_BUF_MASK;
+		uint8_t untilEnd = TRF_RX_BUFFER_SIZE - dataAddr;
+		frame.data1 = (const byte*) &rcvdBytesBuf[dataAddr];
+		frame.data2 = (const byte*) &rcvdBytesBuf[0];
+		if(dataLen > untilEnd){
+			frame.len1 = untilEnd;
+			frame.len2 = dataLen - untilEnd;
+		}
+		else{
+			frame.len1 = dataLen;
+			frame.len2 = 0;
+		}
+
+		if(peekedBefore){
+			return TRF_ERR_SUCCESS;
+		}
+
+		/*** error checking ***/
+		#if defined(TRF_RX_ISR_ERR_CHK)
+			if(errChckRcvd != TRF_ERR_SUCCESS){
+				consumeReceivedData();
+				frame.len1 = frame.len2 = 0;
+				return errChckRcvd;
+			}
+		#elif !defined(TRF_ERROR_CHECKING_NONE)
+			TRF_ERR_CHK_TYPE errChckCalc = frame_err_chk(frame, TRF_ERR_CHK_SEED(addr, seq));
+			if(errChckRcvd != errChckCalc){
+				consumeReceivedData();
+				frame.len1 = frame.len2 = 0;
+				TRF_STATS_INC_MAIN(corrupted);
+				return TRF_ERR_CORRUPTED;
+			}
+			//if all data is zeroes CRC will also be zero and CRC check will pass
+			else if( (errChckRcvd|errChckCalc) == 0){
+				boolean allZeroes = true;
+				for(uint8_t i=0; i<frame.len1; i++){
+					if(frame.data1[i] != 0x00){
+						allZeroes = false;
+					}
+				}
+				for(uint8_t i=0; i<frame.len2; i++){
+					if(frame.data2[i] != 0x00){
+						allZeroes = false;
+					}
+				}
+				if(allZeroes){
+					consumeReceivedData();
+					frame.len1 = frame.len2 = 0;
+					TRF_STATS_INC_MAIN(noise);
+					return TRF_ERR_NOISE;
+				}
+			}
+		#endif
+
+		/*** sequence number ***/
+		#ifndef TRF_SEQ_DISABLED
+			if(check_seq(addr, seq, numLostMsgs) == TRF_ERR_DUPLICATE_MSG){
+				consumeReceivedData();
+				continue;
+			}
+		#endif
+
+		return TRF_ERR_SUCCESS;
+
+	}
+
+}
+
+uint8_t peekReceivedData(TRFFrame &frame){
+	uint8_t l = 0;
+	return peekReceivedData(frame, l);
+}
+
+bool consumeReceivedData(){
+	using namespace tinyrf;
+	if(!peekPending){
+		return false;
+	}
+	peekPending = false;
+	return consume_frame(peekedFrameAddr);
+}
+
+#endif	/* TRF_DATA_NATURAL_ORDER */
+
 #endif /* TRF_TINY_RX_CPP */
\ No newline at end of file
@@ -4,18 +4,22 @@
 #include "TinyRF.h"
 
 /**
- * Board detection
+ * Timer1 settings, the rest are in TinyRF.h
 **/
-#if defined(__AVR_ATtiny2313__) || defined(__AVR_ATtiny4313__)
-	#define TRF_MCU_TinyX313
-#elif defined(__AVR_ATtiny24__) || defined(__AVR_ATtiny44__) || defined(__AVR_ATtiny84__)
-	#define TRF_MCU_TinyX4
-#elif defined(__AVR_ATtiny25__) || defined(__AVR_ATtiny45__) || defined(__AVR_ATtiny85__)
-	#define TRF_MCU_TinyX5
-#elif defined(__AVR_ATtiny167__) || defined(__AVR_ATtiny87__)
-	#define TRF_MCU_TinyX7
-#elif defined(ESP8266) || defined(ESP32)
-	#define TRF_MCU_ESP
+#if defined(TRF_RX_INPUT_CAPTURE) || defined(TRF_EOT_TIMER)
+
+	#ifndef TRF_MCU_MegaX8
+		#error "TRF_RX_INPUT_CAPTURE and TRF_EOT_TIMER are only supported on ATmega328 and similar MCUs."
+	#endif
+
+	//ICP1 is PB0, which is pin 8 on Arduino Uno/Nano
+	#define TRF_ICP_PIN 8
+
+#endif
+
+
+#if defined(TRF_LINE_CODE_MANCHESTER) && defined(TRF_RX_ADAPTIVE_THRESHOLDS)
+	#error "TRF_RX_ADAPTIVE_THRESHOLDS can't be used with TRF_LINE_CODE_MANCHESTER."
 #endif
 
 
@@ -47,6 +51,64 @@
 #endif
 
 
+/**
+ * Receive buffer
+ * Indexes are free running 8-bit numbers that are wrapped using a mask, so the buffer size has to be
+ * a power of two, and at most 128 so the distance between two indexes fits in a byte
+**/
+#define TRF_RX_BUF_MASK (TRF_RX_BUFFER_SIZE - 1)
+
+//a frame's minimum length is CRC + ADDR + SEQ + 1 Byte Data
+#if defined(TRF_ERROR_CHECKING_CRC16) && !defined(TRF_SEQ_DISABLED)
+	#define TRF_MIN_FRAME_LEN (4 + TRF_ADDR_SIZE)
+#else
+	#define TRF_MIN_FRAME_LEN (3 + TRF_ADDR_SIZE)
+#endif
+
+/**
+ * Clock used by TRF_RX_PROFILE
+ * If Timer1 is running we use it because micros() only has a 4us resolution on AVR
+**/
+#ifdef TRF_RX_PROFILE
+	#if defined(TRF_RX_INPUT_CAPTURE) || defined(TRF_EOT_TIMER)
+		#define TRF_PROFILE_CLOCK() TCNT1
+		#define TRF_PROFILE_TICKS_PER_US (1 << TRF_TIMER1_TICK_SHIFT)
+	#else
+		#define TRF_PROFILE_CLOCK() ((uint16_t)micros())
+		#define TRF_PROFILE_TICKS_PER_US 1
+	#endif
+#endif
+
+/**
+ * Histogram of TRF_RX_HISTOGRAM
+ * Bins are 2^RX_HIST_BIN_SHIFT microseconds wide, the shift is the smallest one that gets the end of
+ * the START window (RX_HIST_RANGE) into the second to last bin
+**/
+#ifdef TRF_RX_HISTOGRAM
+	#if (TRF_RX_HIST_BINS < 8) || (TRF_RX_HIST_BINS > 255)
+		#error "TRF_RX_HIST_BINS has to be between 8 and 255."
+	#endif
+	#ifdef TRF_LINE_CODE_MANCHESTER
+		const uint16_t RX_HIST_RANGE = MANCHESTER_START_DURATION + 2*MANCHESTER_TRIGG_ERROR;
+	#else
+		const uint16_t RX_HIST_RANGE = START_PULSE_PERIOD + START_PULSE_MAX_ERROR;
+	#endif
+	constexpr uint8_t rx_hist_bin_shift(uint8_t shift){
+		return (RX_HIST_RANGE >> shift) < TRF_RX_HIST_BINS - 1 ? shift : rx_hist_bin_shift(shift + 1);
+	}
+	const uint8_t RX_HIST_BIN_SHIFT = rx_hist_bin_shift(0);
+#endif
+
+//there is nothing to check in the interrupt without error checking
+#ifdef TRF_ERROR_CHECKING_NONE
+	#undef TRF_RX_ISR_ERR_CHK
+#endif
+
+#if (TRF_RX_BUFFER_SIZE > 128) || ((TRF_RX_BUFFER_SIZE & TRF_RX_BUF_MASK) != 0)
+	#error "TRF_RX_BUFFER_SIZE has to be a power of two and not larger than 128."
+#endif
+
+
 /**
  * Error codes returned by getReceivedData()
 **/
@@ -63,6 +125,69 @@
 #define TRF_ERR_NOISE 11
 
 
+/**
+ * A message's data as it sits in the receive buffer, returned by peekReceivedData()
+ * Because the buffer is circular the data might wrap around the end of it, in that case the first 
+ * part of the data is in data1 and the rest is in data2, otherwise len2 is zero
+**/
+typedef struct{
+	const byte* data1;
+	uint8_t len1;
+	const byte* data2;
+	uint8_t len2;
+#ifdef TRF_SENDER_ADDRESSING
+	uint8_t senderAddr;		// TRF_TX_ADDRESS of the transmitter that sent the message
+#endif
+} TRFFrame;
+
+
+/**
+ * Describes one message returned by drainReceivedData()
+**/
+typedef struct{
+	uint8_t err;			// TRF_ERR_SUCCESS, TRF_ERR_CORRUPTED or TRF_ERR_BUFFER_OVERFLOW
+	uint8_t offset;			// where the message's data starts in buf
+	uint8_t len;			// number of data bytes, zero if the message is corrupted or too long
+	uint8_t numLostMsgs;	// number of messages that were lost before this message
+#ifdef TRF_SENDER_ADDRESSING
+	uint8_t senderAddr;		// TRF_TX_ADDRESS of the transmitter that sent the message
+#endif
+} TRFMsgInfo;
+
+
+/**
+ * Receiver counters returned by getRxStats()
+ * The 16-bit counters wrap around, compare two readings to get the number of events in between
+**/
+typedef struct{
+	uint16_t edges;			// pulses the interrupt has seen
+	uint16_t starts;		// START pulses
+	uint16_t frames;		// frames that were put in the buffer
+	uint16_t noise;			// frames thrown away as noise: too short, all zeroes or an invalid 'len'
+	uint16_t corrupted;		// frames that failed error checking
+	uint16_t evictions;		// frames that were overwritten in the buffer before they were read
+	uint16_t duplicates;	// repeats of messages that were dropped
+	uint8_t highWater;		// most bytes of the buffer that have ever been in use at once
+} TRFRxStats;
+
+
+/**
+ * Durations returned by getRxProfile(), see TRF_RX_PROFILE for the unit
+ * avg is the average of the last 32768 or so, all of them are zero if nothing has been measured
+**/
+typedef struct{
+	uint16_t min;
+	uint16_t avg;
+	uint16_t max;
+} TRFTiming;
+
+typedef struct{
+	TRFTiming edge;			// interrupts that only decoded a pulse
+	TRFTiming byteEdge;		// interrupts that also completed a byte and put it in the buffer
+	TRFTiming read;			// calls to getReceivedData()
+} TRFRxProfile;
+
+
 /**
  * Function definitions
 **/
@@ -70,6 +195,9 @@
 // Sets up the receiver. Needs to be called in setup()
 void setupReceiver(uint8_t pin);
 
+// Interrupt routine used when pulses are timed with an external interrupt and micros()
+// It is called on falling edges, or on both edges with TRF_LINE_CODE_MANCHESTER
+// When TRF_RX_INPUT_CAPTURE is enabled TIMER1_CAPT_vect is used instead
 void interrupt_routine();
 
 // Gets "one" message from the received data buffer
@@ -83,11 +211,69 @@ uint8_t getReceivedData(byte buf[], uint8_t bufSize, uint8_t &numRcvdBytes, uint
 // Returns one of the errors codes defined in TinyRF_RX.h
 uint8_t getReceivedData(byte buf[],  uint8_t bufSize, uint8_t &numRcvdBytes);
 
-// Functions for buffer addition/substraction
-// They ensure a number doesn't surpass a certain value when added/substracted
-void lim_inc(volatile uint8_t &num);
-void lim_sum(volatile uint8_t &num, uint16_t c);
-void lim_dec(volatile uint8_t &num);
-void lim_sub(volatile uint8_t &num, uint16_t c);
+#ifdef TRF_SENDER_ADDRESSING
+// Same as above, the address of the transmitter that sent the message will be put in senderAddr
+// Lost and duplicate messages are counted separately for each transmitter
+uint8_t getReceivedData(byte buf[], uint8_t bufSize, uint8_t &numRcvdBytes, uint8_t &numLostMsgs, 
+	uint8_t &senderAddr);
+#endif
+
+// Gets "all" the messages in the received data buffer at once
+// The data of the messages is put one after the other in buf, and each message is described by 
+// an element of msgs. Messages that don't fit in buf or msgs are left for the next call, except for
+// messages that are longer than bufSize which are reported as TRF_ERR_BUFFER_OVERFLOW and dropped
+// Duplicate messages are skipped like in getReceivedData()
+// Returns the number of elements put in msgs
+uint8_t drainReceivedData(byte buf[], uint8_t bufSize, TRFMsgInfo msgs[], uint8_t maxMsgs);
+
+#ifdef TRF_RX_FILTER
+// Sets a function that decides which messages are kept, it should return true to keep a message
+// It gets the length of the data, the sender's address (0 without TRF_SENDER_ADDRESSING) and the 
+// first byte of data that was sent, which is the last byte of the data unless TRF_DATA_NATURAL_ORDER
+// is enabled. The message hasn't been error checked yet.
+// It's called from an interrupt so it should be short
+void setReceiveFilter(bool (*filter)(uint8_t len, uint8_t senderAddr, byte firstByte));
+#endif
+
+#ifdef TRF_RX_STATS
+// Copies the receiver counters into stats
+void getRxStats(TRFRxStats &stats);
+
+// Sets all receiver counters to zero
+void resetRxStats();
+#endif
+
+#ifdef TRF_RX_PROFILE
+// Copies the measured durations into profile
+void getRxProfile(TRFRxProfile &profile);
+
+// Forgets all the measured durations
+void resetRxProfile();
+#endif
+
+#ifdef TRF_RX_HISTOGRAM
+// Prints the histogram of pulse periods to Serial, one line for each bin that isn't empty
+// Each line has the bin's range in microseconds, its count and the window(s) the range falls in
+void printRxHistogram();
+
+// Empties the histogram
+void resetRxHistogram();
+#endif
+
+#ifdef TRF_DATA_NATURAL_ORDER
+
+// Gets "one" message from the received data buffer without copying it
+// If TRF_ERR_SUCCESS is returned 'frame' points to the message data inside the buffer and 
+// consumeReceivedData() has to be called when you are done with it
+// Any other return code means the message has already been removed from the buffer
+// Calling this again before consumeReceivedData() returns the same message
+uint8_t peekReceivedData(TRFFrame &frame, uint8_t &numLostMsgs);
+uint8_t peekReceivedData(TRFFrame &frame);
+
+// Removes the message returned by peekReceivedData() from the buffer
+// Returns false if the message was overwritten by newer messages while you were using it
+bool consumeReceivedData();
+
+#endif
 
 #endif	/* TRF_TINY_RX_H */
\ No newline at end of file
@@ -9,25 +9,77 @@
 **/
 
 
+/**
+ * Instead of editing this file you can also choose the settings in your sketch, by defining them 
+ * before including TinyRF_RX.h or TinyRF_TX.h (or with compiler flags). 
+ * The defaults in this file are only used for settings that haven't been chosen that way, so e.g. 
+ * defining TRF_ERROR_CHECKING_CHECKSUM in your sketch replaces the default TRF_ERROR_CHECKING_CRC.
+ * This way different sketches can use different settings without changing the library.
+**/
+
+
 
 /**
  * The pin that is connected to the transmission module.
 **/
+#ifndef TRF_TX_PIN
 #define TRF_TX_PIN 2
+#endif
 
 
 /**
  * What kind of error checking should be used.
  * CRC detects more errors but uses ~20bytes more program space.
  * Checksum detects less errors.
+ * CRC16 adds one more byte to each frame but detects a lot more errors in long messages. Use it 
+ * if you send messages longer than ~30 bytes. It also uses more program space than CRC.
  * Alternatively you can use TRF_ERROR_CHECKING_NONE to disable error checking altogether.
  * Note: Error checking can only detect if a data was corrupted during transmission.
  * It cannot recover the original data. So you still need to send a message multiple times to 
  * make sure it is received.
 **/
+#if !defined(TRF_ERROR_CHECKING_CRC16) && !defined(TRF_ERROR_CHECKING_CHECKSUM) \
+	&& !defined(TRF_ERROR_CHECKING_NONE)
 #define TRF_ERROR_CHECKING_CRC
+//#define TRF_ERROR_CHECKING_CRC16
 //#define TRF_ERROR_CHECKING_CHECKSUM
 //#define TRF_ERROR_CHECKING_NONE
+#endif
+
+
+/**
+ * How the CRC is calculated when TRF_ERROR_CHECKING_CRC is used.
+ * By default it's calculated bit by bit, which is the smallest and best for ATtiny13.
+ * TRF_CRC8_NIBBLE_TABLE uses a 16 byte table and is about 2-3 times faster.
+ * TRF_CRC8_BYTE_TABLE uses a 256 byte table and is many times faster. Good for MCUs with 
+ * plenty of flash like ATmega328 and ESP8266.
+ * The result is the same, so the transmitter and the receiver don't have to use the same one.
+**/
+//#define TRF_CRC8_NIBBLE_TABLE
+//#define TRF_CRC8_BYTE_TABLE
+
+
+/**
+ * Uncomment this to do the error checking in the receiver's interrupt as bytes arrive instead of
+ * doing it all in getReceivedData(). This makes getReceivedData() faster, especially with long 
+ * messages, and the interrupt takes a little longer for each byte.
+ * Messages that fail the check are thrown away by the interrupt so they don't take up buffer space,
+ * which means getReceivedData() doesn't return TRF_ERR_CORRUPTED, TRF_RX_STATS still counts them.
+ * Only affects the receiver.
+**/
+//#define TRF_RX_ISR_ERR_CHK
+
+
+/**
+ * Uncomment this to enable forward error correction.
+ * Every byte of the frame (except the preamble) is sent as two Hamming(8,4) codewords which allows 
+ * the receiver to fix one wrong bit in each half of every byte instead of dropping the message.
+ * Errors that can't be fixed are still detected by error checking.
+ * This doubles the time it takes to send the frame (not the preamble) so it's only worth it on noisy 
+ * links, but it's still much faster than sending a message 3 times with sendMulti().
+ * This has to be the same in the transmitter and the receiver.
+**/
+//#define TRF_FEC_HAMMING
 
 
 /**
@@ -40,6 +92,92 @@
 //#define TRF_SEQ_DISABLED
 
 
+/**
+ * Uncomment this if more than one transmitter sends to the same receiver.
+ * Each transmitter then sends its own address (TRF_TX_ADDRESS, 0-255) with every message and the 
+ * receiver keeps the sequence numbers of each transmitter separately, otherwise the sequence numbers
+ * of different transmitters get mixed up which causes wrong lost message counts and duplicates
+ * that aren't detected. 
+ * Use the getReceivedData() that has a 'senderAddr' argument to get the address of each message.
+ * TRF_RX_MAX_SENDERS is the number of transmitters the receiver keeps track of, each uses 2 bytes 
+ * of RAM. If there are more, the one that was first heard from is forgotten.
+ * TRF_RX_DUP_WINDOW is how many of the last sequence numbers of a transmitter count as duplicates. 
+ * With 1 only repeats of the last message are duplicates. This also works without addressing.
+ * Needs sequence numbering. This has to be the same in the transmitter and the receiver.
+**/
+//#define TRF_SENDER_ADDRESSING
+#ifndef TRF_TX_ADDRESS
+#define TRF_TX_ADDRESS 0
+#endif
+#ifndef TRF_RX_MAX_SENDERS
+#define TRF_RX_MAX_SENDERS 8
+#endif
+#ifndef TRF_RX_DUP_WINDOW
+#define TRF_RX_DUP_WINDOW 1
+#endif
+
+
+/**
+ * Uncomment this to be able to set a filter with setReceiveFilter() that decides which messages 
+ * are put in the receive buffer. It is called from the receiver interrupt as soon as the first 
+ * byte of data of a message is received, and if it returns false the space the message has taken
+ * so far is freed and the rest of it is ignored. This way on a busy channel messages that aren't
+ * for us don't push the ones we need out of the buffer.
+ * Only affects the receiver.
+**/
+//#define TRF_RX_FILTER
+
+
+/**
+ * Uncomment this to have the receiver count what happens to the pulses and messages it receives,
+ * read the counters with getRxStats() and zero them with resetRxStats(). This tells you whether 
+ * messages are lost to noise, failed error checks, or a reader that is too slow to keep up with
+ * the buffer. When disabled the counters aren't compiled at all.
+ * Only affects the receiver.
+**/
+//#define TRF_RX_STATS
+
+
+/**
+ * Uncomment this to measure how long the receiver interrupt and getReceivedData() take, read the 
+ * results with getRxProfile() and start over with resetRxProfile().
+ * With TRF_RX_INPUT_CAPTURE or TRF_EOT_TIMER the times are in Timer1 ticks, otherwise they are 
+ * in microseconds as returned by micros(), see TRF_PROFILE_TICKS_PER_US. With input capture the 
+ * interrupt's time is counted from the edge, so it includes the time it took for it to start.
+ * This adds a little to every interrupt so only use it to find out what your setup can handle.
+ * Only affects the receiver.
+**/
+//#define TRF_RX_PROFILE
+
+
+/**
+ * Uncomment this to count the pulse periods the receiver sees in a histogram, and print it to Serial 
+ * with printRxHistogram(). Each bin is labeled with the window it falls in (ZERO, ONE, START...) or
+ * "noise", so you can see how far the pulses of your transmitters are from the edges of the windows
+ * when tuning TRIGGER_ERROR and TRF_CALIB_ERROR. Start over with resetRxHistogram().
+ * With TRF_RX_ADAPTIVE_THRESHOLDS the labels are the default windows, not the ones scaled for each frame.
+ * TRF_RX_HIST_BINS is the number of bins, each one takes 2 bytes of RAM. The bins are made as wide
+ * as needed to cover everything up to the end of the START window, the last one counts everything
+ * longer than that.
+ * Only affects the receiver.
+**/
+//#define TRF_RX_HISTOGRAM
+#ifndef TRF_RX_HIST_BINS
+#define TRF_RX_HIST_BINS 64
+#endif
+
+
+/**
+ * Uncomment this to send the data in its original order.
+ * By default the transmitter sends data[] backwards because that uses less program space, so the 
+ * receiver reverses it while copying it out of its buffer.
+ * With this enabled the data sits in the receive buffer in its original order so it can be used 
+ * directly with peekReceivedData() and consumeReceivedData() without copying it.
+ * This has to be the same in the transmitter and the receiver.
+**/
+//#define TRF_DATA_NATURAL_ORDER
+
+
 /**
  * Data rate presets
  * 
@@ -51,7 +189,12 @@
  * So if our 0 pulse period is 500 then our error margin is 500-50-30 to 500+50+30
  * In my experience TRF_BITRATE_1000 was a good option with ATtiny13 as TX
  * If you are using an Arduino as TX you can go up to TRF_BITRATE_2000 speed.
- * If you need custom speeds you can define one for yourself in the header file "TinyRF.h"
+ * If you need a custom speed define TRF_BITRATE_CUSTOM as the bits per second you want instead of 
+ * using a preset, e.g. #define TRF_BITRATE_CUSTOM 1500, and all pulse timings are calculated from it.
+ * TRF_LATENCY_BUDGET is how many microseconds of error (other than the TX clock error) a pulse can 
+ * have, e.g. because of interrupts and delayMicroseconds(), it's 30 by default.
+ * If the speed is too fast for your TRF_TX_* calibration you will get a compile error.
+ * Use airtimeMicros(len) to find out how long sending a message takes.
  *
  * Preabmle:
  * Preabmle to send before each transmission to get the receiver tuned.
@@ -59,7 +202,35 @@
  * In my experiments a preabmle of ~50ms was needed (the faster the datarate the more preabmle needed).
  * However Internet suggests much shorter times.
 **/
+#if !defined(TRF_BITRATE_200) && !defined(TRF_BITRATE_500) && !defined(TRF_BITRATE_2000) \
+	&& !defined(TRF_BITRATE_CUSTOM)
 #define TRF_BITRATE_1000
+//#define TRF_BITRATE_CUSTOM 1500
+//#define TRF_LATENCY_BUDGET 30
+#endif
+
+
+/**
+ * Uncomment this to send 2 bits in every pulse instead of 1, using 4 different pulse periods.
+ * This halves the number of pulses in each byte, so the receiver interrupt runs half as often and
+ * messages are sent about 35% faster.
+ * The pulse periods are closer together so the timings have to be accurate, which means
+ * this can't be used with TRF_TX_UNCALIBRATED. Use it with TRF_TX_CRYSTAL if you can.
+ * This has to be the same in the transmitter and the receiver.
+**/
+//#define TRF_SYMBOLS_4LEVEL
+
+
+/**
+ * Uncomment this to use manchester code instead of pulse period encoding.
+ * With pulse period encoding a 1 takes longer to send than a 0 so the speed depends on the data.
+ * With manchester code every bit takes the same (short) time and is half HIGH and half LOW, which 
+ * roughly doubles the speed for the same bitrate preset when the data has lots of 1s.
+ * The receiver interrupt is called on both edges so it runs twice as often.
+ * Can't be used with TRF_RX_ADAPTIVE_THRESHOLDS.
+ * This has to be the same in the transmitter and the receiver.
+**/
+//#define TRF_LINE_CODE_MANCHESTER
 
 
 /**
@@ -67,9 +238,74 @@
  * If you are using a calibrated internal oscillator for transmitter choose TRF_TX_CALIBRATED
  * If you are using an Arduino or any other MCU with a crystal oscillator choose TRF_TX_CRYSTAL
 **/
+#if !defined(TRF_TX_CALIBRATED) && !defined(TRF_TX_CRYSTAL)
 #define TRF_TX_UNCALIBRATED
 //#define TRF_TX_CALIBRATED
 //#define TRF_TX_CRYSTAL
+#endif
+
+
+/**
+ * Uncomment this to make the receiver learn the transmitter's timing from the preamble.
+ * The receiver measures the zero pulse period during the preamble and scales the 1/0/START pulse 
+ * windows of that frame accordingly. This way the windows don't need to be padded by the 
+ * transmitter's clock error (TRF_TX_UNCALIBRATED/TRF_TX_CALIBRATED) which allows an uncalibrated 
+ * ATtiny to be used with faster data rates such as TRF_BITRATE_2000.
+ * This only affects the receiver, it uses 12 more bytes of RAM and a little more program space.
+**/
+//#define TRF_RX_ADAPTIVE_THRESHOLDS
+
+
+/**
+ * [ ATmega328 and similar MCUs only ]
+ * Uncomment this to time received pulses with the Timer1 input capture unit instead of an external 
+ * interrupt + micros().
+ * The timer value is latched by hardware on each edge so there's no interrupt latency jitter in the 
+ * measured pulse periods and the interrupt is much cheaper because it doesn't call micros().
+ * Recommended if you want to use TRF_BITRATE_2000.
+ * When this is enabled:
+ * - The receiver module has to be connected to the ICP1 pin, which is pin 8 on Arduino Uno/Nano
+ *   The pin passed to setupReceiver() will be ignored.
+ * - Timer1 will be used by the library, so analogWrite() on pins 9 and 10 and libraries that use
+ *   Timer1 (such as Servo) won't work
+ * This works well together with TRF_EOT_TIMER since both use Timer1.
+**/
+//#define TRF_RX_INPUT_CAPTURE
+
+
+/**
+ * [ ATmega328 and similar MCUs only ]
+ * Uncomment this to make send() and sendMulti() return right away instead of waiting until the 
+ * message is sent. The message is put in a queue and sent in the background by a Timer1 interrupt.
+ * Use isSending() to check if everything has been sent, or setSendCallback() to be notified.
+ * If the queue is full send() waits until there's room for the message.
+ * Timer1 will be used by the library, so analogWrite() on pins 9 and 10 and libraries that use
+ * Timer1 (such as Servo) won't work. This works together with TRF_RX_INPUT_CAPTURE and TRF_EOT_TIMER.
+ * Don't call transmitByte() yourself when this is enabled.
+**/
+//#define TRF_TX_ASYNC
+
+/**
+ * [ ATmega328 and similar MCUs only, needs TRF_TX_ASYNC ]
+ * Uncomment this to let the Timer1 output compare unit change the transmitter pin, instead of 
+ * digitalWrite() in the interrupt. The pin changes on the exact timer tick so there are no timing 
+ * errors in the pulses at all, which makes faster data rates such as TRF_BITRATE_2000 a lot more 
+ * reliable, especially with TRF_TX_CRYSTAL and TRF_RX_INPUT_CAPTURE on the receiver.
+ * The receiver's pulse windows (TRIGGER_ERROR) are not made any tighter for this, since a receiver
+ * can't tell which transmitters use it, so it doesn't add any new data rates either.
+ * The transmitter has to be connected to OC1A, which is pin 9 on Arduino Uno/Nano. 
+ * TRF_TX_PIN will be ignored.
+**/
+//#define TRF_TX_OUTPUT_COMPARE
+
+/**
+ * Size of the TRF_TX_ASYNC send queue in bytes, each message takes its length + TRF_FRAME_OVERHEAD + 3
+ * bytes (6 with the default CRC and sequence numbering), send() returns false for messages that don't fit
+ * The size has to be a power of two (16, 32, 64 or 128)
+**/
+#ifndef TRF_TX_BUFFER_SIZE
+#define TRF_TX_BUFFER_SIZE 64
+#endif
 
 
 /**
@@ -78,12 +314,16 @@
  * When buffer is full it will start from the beggining, rewriting data regardless of it being read or not
  * The size of the buffer depends on how much RAM you have available, how big your messages are,
  * how frequently you send them and how frequently you call getReceivedData() in your receiver code
- * Note that when you use sendMulti() all of the messages will be stored in buffer until read with getReceivedData()
+ * Note that when you use sendMulti() only the first copy of each message is stored, the receiver drops the
+ * repetitions as they arrive. This needs sequence numbering, with TRF_SEQ_DISABLED all copies are stored
  * How to calculate: 
- * minimum buffer size = (message length + 3) * repetition
- * So if you wanna do sendMulti("hello", 5, 2) you're gonna need (5 + 3) * 2 = 16 bytes of buffer
+ * minimum buffer size = (message length + 3) * number of messages you send before reading them
+ * So if you wanna do sendMulti("hello", 5, 2) twice you're gonna need (5 + 3) * 2 = 16 bytes of buffer
+ * The size has to be a power of two (16, 32, 64 or 128)
 **/
+#ifndef TRF_RX_BUFFER_SIZE
 #define TRF_RX_BUFFER_SIZE 128
+#endif
 
 
 /**
@@ -106,9 +346,14 @@
  * The default is EOT_IN_RX because we want to minimize the transmitter code size
  * You can uncomment TRF_EOT_IN_TX if you want EOT to be done in transmitter which is more reliable
  * Alternatively you can uncomment TRF_EOT_NONE if you think you don't need this
+ * On ATmega328 and similar MCUs you can uncomment TRF_EOT_TIMER to use Timer1 for detecting the 
+ * silence instead of getReceivedData(). This way EOT happens exactly MIN_TX_INTERVAL_REAL after the 
+ * last pulse no matter how often getReceivedData() is called. Timer1 will be used by the library 
+ * so analogWrite() on pins 9 and 10 and libraries that use Timer1 (such as Servo) won't work
 **/
 //#define TRF_EOT_IN_TX
 //#define TRF_EOT_NONE
+//#define TRF_EOT_TIMER
 
 
 
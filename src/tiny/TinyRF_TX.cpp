@@ -9,64 +9,111 @@
 
 void setupTransmitter(){
 	pinMode(TRF_TX_PIN, OUTPUT);
+#ifdef TRF_TX_ASYNC
+	TRF_TX_LOW();
+	cli();
+	#ifdef TRF_TX_OUTPUT_COMPARE
+	TCCR1A = (1 << COM1A1);		// normal mode, OC1A goes LOW on compare match
+	#else
+	TCCR1A = 0;					// normal mode, no PWM
+	#endif
+	//keep the input capture bits in case the receiver has set them
+	TCCR1B = (TCCR1B & ((1 << ICNC1) | (1 << ICES1))) | (1 << CS11);	// prescaler 8
+	TIMSK1 &= ~(1 << OCIE1A);
+	sei();
+#endif
 }
 
+#ifndef TRF_TX_ASYNC
+
 /**
  * Notes:
  * When the receiver is an Arduino:
  * Using digitalWrite() and delayMicroseconds() we will have frequent 8-12us timing errors
  * Using native AVR code (PORTx/_delay_us) will decrease the error rate to frequent 4us errors
  * Disabling interrupts during transmission + native AVR reduces errors to occasional 4us errors
- * With our 100+us timings even a 50us error is forgiveable so we'll just stick with digitalWrite()
+ * With our 100+us timings even a 50us error is forgiveable, but digitalWrite() also adds a constant
+ * delay to every edge that depends on the core, so where we can we use TRF_TX_HIGH()/TRF_TX_LOW()
+ * which write to the port directly (see TinyRF_TX.h)
  * Regarding Flash usage, it appears MicroCore's ATtiny13 optimizer already does the convertsion
- * and in my tests there was no difference between using digitalWrite() and native code
+ * so on ATtiny13 there's no difference between the two
 **/
-void send(byte* data, uint8_t len, boolean incrementSeq){
+bool send(byte* data, uint8_t len, boolean incrementSeq){
+
+	//the receiver would drop it
+	if(len > TRF_MAX_MSG_LEN){
+		return false;
+	}
 
 	//we calculate the crc here, because if we do it after the transmission has started 
 	//it will create a delay during transmission which causes the receiver to lose accuracy
 	#ifndef TRF_ERROR_CHECKING_NONE
 		#ifndef TRF_SEQ_DISABLED
-			byte errChck = TRF_ERR_CHK_FUNC(data, len, seq);
+			TRF_ERR_CHK_TYPE errChck = TRF_ERR_CHK_FUNC(data, len, TRF_ERR_CHK_SEED(TRF_TX_ADDRESS, seq));
 		#else
-			byte errChck = TRF_ERR_CHK_FUNC(data, len);
+			TRF_ERR_CHK_TYPE errChck = TRF_ERR_CHK_FUNC(data, len);
 		#endif
 	#endif
 
 	//preamble
 	//based on our pulse period our zeroes have more HIGH time than our ones
 	//so we send zero bytes as preamble
-	for(uint8_t i=0; i<NUM_PREAMBLE_BYTES; i++){
+	for(uint8_t i=0; i<TX_PREAMBLE_BYTES; i++){
 		transmitByte(0x00);
 	}
 
+#ifdef TRF_LINE_CODE_MANCHESTER
+	//START: a long HIGH followed by a 1 bit
+	//the receiver uses the edges of the 1 to find the middle of the bits
+	TRF_TX_HIGH();
+	delayMicroseconds(MANCHESTER_START_DURATION);
+	TRF_TX_LOW();
+	delayMicroseconds(MANCHESTER_HALF_BIT);
+	TRF_TX_HIGH();
+	delayMicroseconds(MANCHESTER_HALF_BIT);
+#else
 	//START pulse
-	digitalWrite(TRF_TX_PIN, LOW);
+	TRF_TX_LOW();
 	delayMicroseconds(START_PULSE_PERIOD - PERIOD_HIGH_DURATION);
-	digitalWrite(TRF_TX_PIN, HIGH);
+	TRF_TX_HIGH();
 	delayMicroseconds(PERIOD_HIGH_DURATION);
+#endif
 
-	transmitByte(len);
+	TRF_TX_FRAME_BYTE(len);
 
-	//error checking byte
+	//error checking byte(s), high byte first
+	#ifdef TRF_ERROR_CHECKING_CRC16
+	TRF_TX_FRAME_BYTE(errChck >> 8);
+	#endif
 	#ifndef TRF_ERROR_CHECKING_NONE
-	transmitByte(errChck);
+	TRF_TX_FRAME_BYTE(errChck);
+	#endif
+
+	//sender address
+	#ifdef TRF_SENDER_ADDRESSING
+	TRF_TX_FRAME_BYTE(TRF_TX_ADDRESS);
 	#endif
 
 	//sequence number
 	#ifndef TRF_SEQ_DISABLED
-	transmitByte(seq);
+	TRF_TX_FRAME_BYTE(seq);
 	#endif
 
 	//data
+#ifdef TRF_DATA_NATURAL_ORDER
+	for(uint8_t i=0; i<len; i++){
+		TRF_TX_FRAME_BYTE(data[i]);
+	}
+#else
 	//we send it like this because it uses less memory
 	while(len--){
-		transmitByte(data[len]);
+		TRF_TX_FRAME_BYTE(data[len]);
 	}
+#endif
 
 	//reset the line to LOW so receiver detects last pulse
 	//because receiver uses falling edges to detect pulses
-	digitalWrite(TRF_TX_PIN, LOW);
+	TRF_TX_LOW();
 
 	//do this after transmission is done so it wouldn't affect the timings
 	#ifndef TRF_SEQ_DISABLED
@@ -79,21 +126,26 @@ void send(byte* data, uint8_t len, boolean incrementSeq){
 	//so we send it some artificial noise to "announce" end of transmission
 	//be careful choosing this because when we're here receiver is expecting a byte not a start pulse
 	//so it's more sensitive
-	//we really need 8 to fill the rcvdPulses[] buffer, but we send 10 just to be sure
+	//a single out of range pulse is enough for the receiver to detect EOT, but we send 10 just to be sure
 #if defined(TRF_EOT_IN_TX) && !defined(TRF_EOT_NONE)
 	for(uint8_t i=0; i<10; i++){
-		delayMicroseconds(PERIOD_HIGH_DURATION/2);
-		digitalWrite(TRF_TX_PIN, HIGH);
-		delayMicroseconds(PERIOD_HIGH_DURATION/2);
-		digitalWrite(TRF_TX_PIN, LOW);
+		delayMicroseconds(TX_NOISE_DURATION);
+		TRF_TX_HIGH();
+		delayMicroseconds(TX_NOISE_DURATION);
+		TRF_TX_LOW();
 	}
 #else
 	//delayMicroseconds(MIN_TX_INTERVAL_REAL*2);
 #endif
 
+	return true;
+
 }
 
-void sendMulti(byte data[], uint8_t len, uint8_t times){
+bool sendMulti(byte data[], uint8_t len, uint8_t times){
+	if(len > TRF_MAX_MSG_LEN){
+		return false;
+	}
 	for(uint8_t i=0; i<times; i++){
 		send(data, len, false);
 		//we wait more than we should because: 
@@ -104,16 +156,450 @@ void sendMulti(byte data[], uint8_t len, uint8_t times){
 	#ifndef TRF_SEQ_DISABLED
 	seq++;
 	#endif
+	return true;
+}
+
+#else	/* TRF_TX_ASYNC */
+
+/**
+ * Each message in the queue is [times][number of bytes][len][error checking][address][seq#][data], where
+ * everything from 'len' is in the order it is sent
+ * The interrupt goes through the message one pulse at a time, the state of that is kept here
+**/
+namespace tinyrf{
+	volatile byte txBuf[TRF_TX_BUFFER_SIZE];
+	//where the next message is written, only changed by send()
+	volatile uint8_t txWriteIndex = 0;
+	//beginning of the message being sent, only changed by the interrupt
+	volatile uint8_t txReadIndex = 0;
+	volatile bool txBusy = false;
+	void (*txCallback)() = NULL;
+
+	enum{TRF_TX_PREAMBLE, TRF_TX_START, TRF_TX_FRAME, TRF_TX_END};
+	uint8_t txState;
+	//number of things done in the current state: preamble bytes, frame bytes, START/EOT segments
+	uint8_t txCount;
+	//how many more times the current message should be sent
+	uint8_t txTimes;
+	//the byte being sent and how many of its bits are left
+	byte txByte;
+	uint8_t txBitsLeft = 0;
+	//whether we are in the second half of the current pulse/bit
+	bool txSecondHalf = false;
+#ifdef TRF_FEC_HAMMING
+	//the low nibble of the current frame byte still has to be sent
+	bool txLowNibble = false;
+#endif
+#ifdef TRF_TX_OUTPUT_COMPARE
+	//duration of the segment that is being sent
+	uint16_t txSegDuration;
+	//the segment that is being sent is the last one in the queue
+	bool txLastSegment;
+#endif
+}
+
+//number of EOT noise segments after each message
+#if defined(TRF_EOT_IN_TX) && !defined(TRF_EOT_NONE)
+	#define TRF_TX_NOISE_SEGMENTS 20
+#else
+	#define TRF_TX_NOISE_SEGMENTS 0
+#endif
+
+//the same delay sendMulti() waits between messages
+const uint16_t TX_GAP_DURATION = MIN_TX_INTERVAL_REAL + TX_INTERVAL_CONST;
+
+
+/**
+ * Gives the next segment of 'txByte', a segment is the time the line stays at one level
+ * Does the same thing transmitByte() does
+**/
+inline void byte_segment(byte &level, uint16_t &duration){
+	using namespace tinyrf;
+	//tx sends bytes MSB first
+#if defined(TRF_SYMBOLS_4LEVEL)
+	if(!txSecondHalf){
+		level = LOW;
+		duration = ZERO_PULSE_PERIOD - PERIOD_HIGH_DURATION + (txByte >> 6)*SYMBOL_STEP;
+	}
+	else{
+		level = HIGH;
+		duration = PERIOD_HIGH_DURATION;
+		txByte <<= 2;
+		txBitsLeft -= 2;
+	}
+#elif defined(TRF_LINE_CODE_MANCHESTER)
+	//a 1 is LOW then HIGH, a 0 is HIGH then LOW
+	bool bit = txByte & 0x80;
+	level = (bit == txSecondHalf) ? HIGH : LOW;
+	duration = MANCHESTER_HALF_BIT;
+	if(txSecondHalf){
+		txByte <<= 1;
+		txBitsLeft--;
+	}
+#else
+	if(!txSecondHalf){
+		level = LOW;
+		duration = ((txByte & 0x80) ? ONE_PULSE_PERIOD : ZERO_PULSE_PERIOD) - PERIOD_HIGH_DURATION;
+	}
+	else{
+		level = HIGH;
+		duration = PERIOD_HIGH_DURATION;
+		txByte <<= 1;
+		txBitsLeft--;
+	}
+#endif
+	txSecondHalf = !txSecondHalf;
+}
+
+//gives the segments of START, returns false when START is over
+inline bool start_segment(byte &level, uint16_t &duration){
+	using namespace tinyrf;
+#ifdef TRF_LINE_CODE_MANCHESTER
+	//a long HIGH followed by a 1 bit
+	const uint8_t numSegments = 3;
+	level = (txCount == 1) ? LOW : HIGH;
+	duration = (txCount == 0) ? MANCHESTER_START_DURATION : MANCHESTER_HALF_BIT;
+#else
+	const uint8_t numSegments = 2;
+	level = (txCount == 0) ? LOW : HIGH;
+	duration = (txCount == 0) ? (START_PULSE_PERIOD - PERIOD_HIGH_DURATION) : PERIOD_HIGH_DURATION;
+#endif
+	return (txCount++ < numSegments);
+}
+
+//puts the next byte of the current frame in 'txByte', returns false when there's none left
+inline bool next_frame_byte(){
+	using namespace tinyrf;
+	uint8_t numBytes = txBuf[(txReadIndex + 1) & TRF_TX_BUF_MASK];
+	byte frameByte = txBuf[(txReadIndex + 2 + txCount) & TRF_TX_BUF_MASK];
+#ifdef TRF_FEC_HAMMING
+	//every byte is sent as two codewords, high nibble first
+	if(txLowNibble){
+		txLowNibble = false;
+		txByte = hamming_encode(frameByte);
+		txCount++;
+		return true;
+	}
+	if(txCount < numBytes){
+		txLowNibble = true;
+		txByte = hamming_encode(frameByte >> 4);
+		return true;
+	}
+#else
+	if(txCount < numBytes){
+		txByte = frameByte;
+		txCount++;
+		return true;
+	}
+#endif
+	return false;
+}
+
+//gets ready to send the message at txReadIndex
+inline void begin_tx_message(){
+	using namespace tinyrf;
+	txTimes = txBuf[txReadIndex & TRF_TX_BUF_MASK];
+	txState = TRF_TX_PREAMBLE;
+	txCount = 0;
+}
+
+/**
+ * Gives the next segment to send, returns false when the queue is empty
+ * Called from the interrupt
+**/
+bool next_tx_segment(byte &level, uint16_t &duration){
+
+	using namespace tinyrf;
+
+	while(1){
+
+		//in the middle of a byte
+		if(txBitsLeft){
+			byte_segment(level, duration);
+			return true;
+		}
+
+		switch(txState){
+
+			//based on our pulse period our zeroes have more HIGH time than our ones
+			//so we send zero bytes as preamble
+			case TRF_TX_PREAMBLE:
+				if(txCount < TX_PREAMBLE_BYTES){
+					txCount++;
+					txByte = 0x00;
+					txBitsLeft = 8;
+					continue;
+				}
+				txState = TRF_TX_START;
+				txCount = 0;
+				//fall through
+
+			case TRF_TX_START:
+				if(start_segment(level, duration)){
+					return true;
+				}
+				txState = TRF_TX_FRAME;
+				txCount = 0;
+				//fall through
+
+			case TRF_TX_FRAME:
+				if(next_frame_byte()){
+					txBitsLeft = 8;
+					continue;
+				}
+				txState = TRF_TX_END;
+				txCount = 0;
+				//fall through
+
+			//reset the line to LOW so receiver detects last pulse, then the EOT noise if enabled, 
+			//then the line stays LOW for as long as sendMulti() waits between messages
+			case TRF_TX_END:
+			#if TRF_TX_NOISE_SEGMENTS
+				if(txCount < TRF_TX_NOISE_SEGMENTS){
+					duration = TX_NOISE_DURATION;
+					level = (txCount & 0x01) ? HIGH : LOW;
+					txCount++;
+					return true;
+				}
+			#endif
+				if(txCount == TRF_TX_NOISE_SEGMENTS){
+					level = LOW;
+					duration = TX_GAP_DURATION;
+					txCount++;
+					return true;
+				}
+				//this message is done
+				txState = TRF_TX_PREAMBLE;
+				txCount = 0;
+				if(--txTimes){
+					continue;
+				}
+				txReadIndex += txBuf[(txReadIndex + 1) & TRF_TX_BUF_MASK] + 2;
+				if(txCallback){
+					txCallback();
+				}
+				if(txReadIndex == txWriteIndex){
+					return false;
+				}
+				begin_tx_message();
+				continue;
+		}
+
+	}
+
+}
+
+#ifndef TRF_TX_OUTPUT_COMPARE
+
+ISR(TIMER1_COMPA_vect){
+	using namespace tinyrf;
+	byte level;
+	uint16_t duration;
+	if(next_tx_segment(level, duration)){
+		TRF_TX_WRITE(level);
+		OCR1A += duration << TRF_TIMER1_TICK_SHIFT;
+	}
+	else{
+		TIMSK1 &= ~(1 << OCIE1A);
+		txBusy = false;
+	}
+}
+
+#else
+
+//tells the hardware to put OC1A at 'level' on the next compare match
+inline void set_OC_level(byte level){
+	TCCR1A = level ? ((1 << COM1A1) | (1 << COM1A0)) : (1 << COM1A1);
+}
+
+//gets the first segment of a message, it starts on the next compare match
+inline void first_OC_segment(){
+	using namespace tinyrf;
+	byte level;
+	next_tx_segment(level, txSegDuration);
+	set_OC_level(level);
+	txLastSegment = false;
+}
+
+/**
+ * The hardware changes the line on the exact timer tick so it doesn't matter when this runs, as 
+ * long as it's before the next change. So we are always one segment ahead: when a segment starts
+ * we already know its duration, and we get the next one to tell the hardware what to do when it ends
+**/
+ISR(TIMER1_COMPA_vect){
+	using namespace tinyrf;
+	if(txLastSegment){
+		//a message might have been queued during the last segment
+		if(txReadIndex == txWriteIndex){
+			TIMSK1 &= ~(1 << OCIE1A);
+			txBusy = false;
+			return;
+		}
+		begin_tx_message();
+		first_OC_segment();
+		OCR1A += 16;
+		return;
+	}
+	OCR1A += txSegDuration << TRF_TIMER1_TICK_SHIFT;
+	byte level;
+	if(next_tx_segment(level, txSegDuration)){
+		set_OC_level(level);
+	}
+	else{
+		//the line stays LOW until the end of the last segment
+		set_OC_level(LOW);
+		txLastSegment = true;
+	}
+}
+
+#endif
+
+/**
+ * Puts a message in the queue and starts sending if we aren't already
+ * Waits if there isn't enough room in the queue
+ * Returns false if the message is too long to be sent, see send()
+**/
+bool enqueue_frame(byte* data, uint8_t len, uint8_t times){
+
+	using namespace tinyrf;
+
+	//'len' + error checking + address + seq# + data, and 'times' and 'number of bytes' before them
+	uint8_t numBytes = 1 + TRF_FRAME_OVERHEAD + len;
+	uint8_t msgSize = numBytes + 2;
+	//the receiver would drop it, or it would never fit in the queue
+	if(len > TRF_MAX_MSG_LEN || msgSize > TRF_TX_BUFFER_SIZE){
+		return false;
+	}
+
+	//we calculate the crc here, because if we do it after the transmission has started 
+	//it will create a delay during transmission which causes the receiver to lose accuracy
+	#ifndef TRF_ERROR_CHECKING_NONE
+		#ifndef TRF_SEQ_DISABLED
+			TRF_ERR_CHK_TYPE errChck = TRF_ERR_CHK_FUNC(data, len, TRF_ERR_CHK_SEED(TRF_TX_ADDRESS, seq));
+		#else
+			TRF_ERR_CHK_TYPE errChck = TRF_ERR_CHK_FUNC(data, len);
+		#endif
+	#endif
+
+	//txReadIndex is only changed by the interrupt so we just wait for it
+	while((uint8_t)(TRF_TX_BUFFER_SIZE - (uint8_t)(txWriteIndex - txReadIndex)) < msgSize);
+
+	uint8_t i = txWriteIndex;
+	txBuf[i++ & TRF_TX_BUF_MASK] = times;
+	txBuf[i++ & TRF_TX_BUF_MASK] = numBytes;
+	txBuf[i++ & TRF_TX_BUF_MASK] = len;
+	#ifdef TRF_ERROR_CHECKING_CRC16
+	txBuf[i++ & TRF_TX_BUF_MASK] = errChck >> 8;
+	#endif
+	#ifndef TRF_ERROR_CHECKING_NONE
+	txBuf[i++ & TRF_TX_BUF_MASK] = errChck;
+	#endif
+	#ifdef TRF_SENDER_ADDRESSING
+	txBuf[i++ & TRF_TX_BUF_MASK] = TRF_TX_ADDRESS;
+	#endif
+	#ifndef TRF_SEQ_DISABLED
+	txBuf[i++ & TRF_TX_BUF_MASK] = seq;
+	#endif
+	#ifdef TRF_DATA_NATURAL_ORDER
+	for(uint8_t j=0; j<len; j++){
+		txBuf[i++ & TRF_TX_BUF_MASK] = data[j];
+	}
+	#else
+	while(len--){
+		txBuf[i++ & TRF_TX_BUF_MASK] = data[len];
+	}
+	#endif
+
+	noInterrupts();
+	txWriteIndex = i;
+	if(!txBusy){
+		txBusy = true;
+		begin_tx_message();
+	#ifdef TRF_TX_OUTPUT_COMPARE
+		first_OC_segment();
+	#endif
+		//start sending a little later
+		OCR1A = TCNT1 + 16;
+		TIFR1 = (1 << OCF1A);
+		TIMSK1 |= (1 << OCIE1A);
+	}
+	interrupts();
+
+	return true;
+
+}
+
+bool send(byte* data, uint8_t len, boolean incrementSeq){
+	if(!enqueue_frame(data, len, 1)){
+		return false;
+	}
+	#ifndef TRF_SEQ_DISABLED
+	if(incrementSeq){
+		seq++;
+	}
+	#endif
+	return true;
+}
+
+bool sendMulti(byte data[], uint8_t len, uint8_t times){
+	if(times == 0){
+		return true;
+	}
+	if(!enqueue_frame(data, len, times)){
+		return false;
+	}
+	#ifndef TRF_SEQ_DISABLED
+	seq++;
+	#endif
+	return true;
+}
+
+bool isSending(){
+	return tinyrf::txBusy;
+}
+
+void setSendCallback(void (*callback)()){
+	tinyrf::txCallback = callback;
 }
 
+#endif	/* TRF_TX_ASYNC */
+
 //sends one byte
 void transmitByte(byte _byte){
+#ifdef TRF_SYMBOLS_4LEVEL
+	//two bits per pulse, most significant pair first
+	//the LOW duration grows with the value of the two bits
+	uint8_t i=8;
+	do{
+		i -= 2;
+		uint8_t symbol = (_byte >> i) & 0x03;
+		TRF_TX_LOW();
+		delayMicroseconds(ZERO_PULSE_PERIOD - PERIOD_HIGH_DURATION + symbol*SYMBOL_STEP);
+		TRF_TX_HIGH();
+		delayMicroseconds(PERIOD_HIGH_DURATION);
+	}while(i);
+#else
 	//we do our loop like this because it uses less memory
 	uint8_t i=7;
 	do{
+#ifdef TRF_LINE_CODE_MANCHESTER
+		//a 1 is LOW then HIGH, a 0 is HIGH then LOW
+		//there's no edge between the bits when they are different
+		if(_byte & (1<<i)){
+			TRF_TX_LOW();
+			delayMicroseconds(MANCHESTER_HALF_BIT);
+			TRF_TX_HIGH();
+		}
+		else{
+			TRF_TX_HIGH();
+			delayMicroseconds(MANCHESTER_HALF_BIT);
+			TRF_TX_LOW();
+		}
+		delayMicroseconds(MANCHESTER_HALF_BIT);
+#else
 		//send the LOW part of the pulse
 		//the LOW duration determines wether a pulse is a 1 or a 0
-		digitalWrite(TRF_TX_PIN, LOW);
+		TRF_TX_LOW();
 		//if 1
 		if(_byte & (1<<i)){
 			delayMicroseconds(ONE_PULSE_PERIOD - PERIOD_HIGH_DURATION);
@@ -123,10 +609,19 @@ void transmitByte(byte _byte){
 		}
 		//send the HIGH part of the pulse
 		//all pulses have the same HIGH duration
-		digitalWrite(TRF_TX_PIN, HIGH);
+		TRF_TX_HIGH();
 		delayMicroseconds(PERIOD_HIGH_DURATION);
-		
+#endif
 	}while(i--);
+#endif
+}
+
+#ifdef TRF_FEC_HAMMING
+//sends one byte, high nibble first, each nibble as a Hamming(8,4) codeword
+void transmitFECByte(byte _byte){
+	transmitByte(hamming_encode(_byte >> 4));
+	transmitByte(hamming_encode(_byte));
 }
+#endif
 
 #endif /* TRF_TINY_TX_CPP */
\ No newline at end of file
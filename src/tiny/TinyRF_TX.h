@@ -4,6 +4,61 @@
 #include "TinyRF.h"
 
 
+#if defined(TRF_TX_OUTPUT_COMPARE) && !defined(TRF_TX_ASYNC)
+	#error "TRF_TX_OUTPUT_COMPARE needs TRF_TX_ASYNC."
+#endif
+
+#ifdef TRF_TX_ASYNC
+	#ifndef TRF_MCU_MegaX8
+		#error "TRF_TX_ASYNC is only supported on ATmega328 and similar MCUs."
+	#endif
+	#ifdef TRF_TX_OUTPUT_COMPARE
+		//the transmitter has to be connected to OC1A, which is pin 9 on Arduino Uno/Nano
+		#undef TRF_TX_PIN
+		#define TRF_TX_PIN 9
+	#endif
+	//the queue is a ring buffer with free running indexes like the receive buffer
+	#define TRF_TX_BUF_MASK (TRF_TX_BUFFER_SIZE - 1)
+	#if (TRF_TX_BUFFER_SIZE > 128) || ((TRF_TX_BUFFER_SIZE & TRF_TX_BUF_MASK) != 0)
+		#error "TRF_TX_BUFFER_SIZE has to be a power of two and not larger than 128."
+	#endif
+#endif
+
+
+/**
+ * Direct port I/O
+ * On boards where we know how pin numbers map to ports, TRF_TX_PIN is turned into a port register
+ * and a bit at compile time, so setting the pin HIGH or LOW is a single sbi/cbi instruction.
+ * On other boards, and for pins the mapping doesn't cover, we fall back to digitalWrite()
+ * The mapping is done by the compiler rather than the preprocessor, because TRF_TX_PIN can be
+ * something like A0 which is a constant in the core but 0 for #if
+**/
+#if defined(TRF_MCU_MegaX8)
+	//pins 0-7 are on PORTD, 8-13 on PORTB and 14-19 (A0-A5) on PORTC
+	#define TRF_TX_PORT_MAPPED ((TRF_TX_PIN) < 20)
+	#define TRF_TX_PORT (*((TRF_TX_PIN) < 8 ? &PORTD : ((TRF_TX_PIN) < 14 ? &PORTB : &PORTC)))
+	#define TRF_TX_BIT ((TRF_TX_PIN) < 8 ? (TRF_TX_PIN) : ((TRF_TX_PIN) < 14 ? (TRF_TX_PIN) - 8 : (TRF_TX_PIN) - 14))
+#elif defined(__AVR_ATtiny13__) || defined(TRF_MCU_TinyX5)
+	//on these all pins are on PORTB and pin numbers are the same as bit numbers
+	#define TRF_TX_PORT_MAPPED ((TRF_TX_PIN) < 6)
+	#define TRF_TX_PORT PORTB
+	#define TRF_TX_BIT (TRF_TX_PIN)
+#endif
+
+#ifdef TRF_TX_PORT
+	//TRF_TX_PORT_MAPPED is a constant so only one of the branches is compiled in
+	//&7 keeps the shift in range in the digitalWrite() case
+	#define TRF_TX_HIGH() do{ if(TRF_TX_PORT_MAPPED) TRF_TX_PORT |= (1 << (TRF_TX_BIT & 7)); \
+		else digitalWrite(TRF_TX_PIN, HIGH); }while(0)
+	#define TRF_TX_LOW() do{ if(TRF_TX_PORT_MAPPED) TRF_TX_PORT &= ~(1 << (TRF_TX_BIT & 7)); \
+		else digitalWrite(TRF_TX_PIN, LOW); }while(0)
+#else
+	#define TRF_TX_HIGH() digitalWrite(TRF_TX_PIN, HIGH)
+	#define TRF_TX_LOW() digitalWrite(TRF_TX_PIN, LOW)
+#endif
+#define TRF_TX_WRITE(level) do{ if(level) TRF_TX_HIGH(); else TRF_TX_LOW(); }while(0)
+
+
 /**
  * Function declarations
 **/
@@ -12,13 +67,33 @@ void setupTransmitter();
 
 // Sends an array of bytes
 // Also appends error checking and sequence numbering
-void send(byte* data, uint8_t len, boolean incrementSeq=true);
+// Returns false and sends nothing if the message is longer than TRF_MAX_MSG_LEN, which the receiver 
+// would drop, or with TRF_TX_ASYNC if it can never fit in the send queue
+bool send(byte* data, uint8_t len, boolean incrementSeq=true);
 
 // Sends an array of bytes 'times' times
-void sendMulti(byte data[], uint8_t len, uint8_t times);
+// Returns false like send()
+bool sendMulti(byte data[], uint8_t len, uint8_t times);
 
 // Sends one byte to the receiver
 void transmitByte(byte _byte);
 
+#ifdef TRF_TX_ASYNC
+// Returns true until all messages given to send() and sendMulti() have been sent
+bool isSending();
+
+// Sets a function to be called every time a send() or sendMulti() is done
+// It's called from an interrupt so it should be short
+void setSendCallback(void (*callback)());
+#endif
+
+#ifdef TRF_FEC_HAMMING
+// Sends one byte as two Hamming(8,4) codewords
+void transmitFECByte(byte _byte);
+#define TRF_TX_FRAME_BYTE transmitFECByte
+#else
+#define TRF_TX_FRAME_BYTE transmitByte
+#endif
+
 
 #endif	/* TRF_TINY_TX_H */
\ No newline at end of file